@@ -0,0 +1,47 @@
+#include <AS5600_bitbang.h>
+#ifdef ARDUINO_SAMD_VARIANT_COMPLIANCE
+  #define SERIAL SerialUSB
+#else
+  #define SERIAL Serial
+#endif
+
+// SDA on pin 2, SCL on pin 3
+AMS_5600_BITBANG<2, 3> ams5600;
+
+unsigned long loops = 0;
+
+/*******************************************************
+/* Function: angleRead
+/* In: status and raw angle of the completed read
+/* Out: none
+/* Description: called from poll() when a read is done
+/*******************************************************/
+void angleRead(AS5600_Status status, word rawAngle)
+{
+  if (status == AS5600_OK) {
+    SERIAL.print(rawAngle);
+    SERIAL.print("\t(main loop ran ");
+    SERIAL.print(loops);
+    SERIAL.println(" times during the read)");
+  }
+  else
+    SERIAL.println("read failed");
+}
+
+void setup()
+{
+  SERIAL.begin(115200);
+  ams5600.beginAngleStream();
+}
+
+void loop()
+{
+  if (!ams5600.readPending()) {
+    loops = 0;
+    ams5600.startRawAngleRead(angleRead);
+  }
+
+  // a few bus steps per pass, the rest of the loop keeps running
+  ams5600.poll();
+  loops++;
+}
@@ -11,8 +11,7 @@ Description:  AS5600 "Potuino" demonstration application
 AMS5600 Programming Sketch
 /***************************************************/
 
-#include <Wire.h>
-#include "AS5600.h"
+#include <AS5600_softwire.h>
 
 #ifdef ARDUINO_SAMD_VARIANT_COMPLIANCE
   #define SERIAL SerialUSB
@@ -25,7 +24,8 @@ AMS5600 Programming Sketch
 String lastResponse;
 String noMagnetStr = "Error: magnet not detected";
 
-AMS_5600 ams5600;
+// SDA on pin 2, SCL on pin 3, any free pins will do
+AMS_5600_SOFTWIRE ams5600(2, 3);
 
 /*******************************************************
 /* function: setup
@@ -35,7 +35,8 @@ AMS_5600 ams5600;
 /*******************************************************/
 void setup(){
  SERIAL.begin(115200);
- Wire.begin();
+ // start/end/max angle are then served from RAM by the getters
+ ams5600.begin();
  printMenu();
 }
 
@@ -71,21 +72,20 @@ void printMenu()
 
 /*******************************************************
 /* Function: convertRawAngleToDegrees
-/* In: angle data from AMS_5600::getRawAngle
+/* In: angle data from AMS_5600_SOFTWIRE::getRawAngle
 /* Out: human readable degrees as float
 /* Description: takes the raw angle and calculates
 /* float value in degrees.
 /*******************************************************/
 float convertRawAngleToDegrees(word newAngle)
 {
-  /* Raw data reports 0 - 4095 segments, which is 0.087 of a degree */
-  float retVal = newAngle * 0.087890625;
-  return retVal;
+  /* Raw data reports 0 - 4095 segments, which is 0.087890625 of a degree */
+  return as5600_toDegrees(newAngle);
 }
 
 /*******************************************************
 /* Function: convertScaledAngleToDegrees
-/* In: angle data from AMS_5600::getScaledAngle
+/* In: angle data from AMS_5600_SOFTWIRE::getScaledAngle
 /* Out: human readable degrees as float
 /* Description: takes the scaled angle and calculates
 /* float value in degrees.
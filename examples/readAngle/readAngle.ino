@@ -1,5 +1,4 @@
-#include <Wire.h>
-#include <AS5600.h>
+#include <AS5600_softwire.h>
 #ifdef ARDUINO_SAMD_VARIANT_COMPLIANCE
   #define SERIAL SerialUSB
   #define SYS_VOL   3.3
@@ -8,14 +7,14 @@
   #define SYS_VOL   5
 #endif
 
-AMS_5600 ams5600;
+// SDA on pin 2, SCL on pin 3, any free pins will do
+AMS_5600_SOFTWIRE ams5600(2, 3);
 
 int ang, lang = 0;
 
 void setup()
 {
   SERIAL.begin(115200);
-  Wire.begin();
   SERIAL.println(">>>>>>>>>>>>>>>>>>>>>>>>>>> ");
   if(ams5600.detectMagnet() == 0 ){
     while(1){
@@ -32,19 +31,24 @@ void setup()
   }
 }
 /*******************************************************
-/* Function: convertRawAngleToDegrees
-/* In: angle data from AMS_5600::getRawAngle
-/* Out: human readable degrees as float
-/* Description: takes the raw angle and calculates
-/* float value in degrees.
+/* Function: printRawAngleAsDegrees
+/* In: angle data from AMS_5600_SOFTWIRE::getRawAngle
+/* Out: none
+/* Description: prints the raw angle in degrees with
+/* two decimals, using integer centidegrees so no
+/* float code is needed.
 /*******************************************************/
-float convertRawAngleToDegrees(word newAngle)
+void printRawAngleAsDegrees(word newAngle)
 {
-  /* Raw data reports 0 - 4095 segments, which is 0.087890625 of a degree */
-  float retVal = newAngle * 0.087890625;
-  return retVal;
+  /* Raw data reports 0 - 4095 segments, 36000 / 4096 centidegrees each */
+  word centidegrees = as5600_toCentidegrees(newAngle);
+  SERIAL.print(centidegrees / 100);
+  SERIAL.print('.');
+  if (centidegrees % 100 < 10)
+    SERIAL.print('0');
+  SERIAL.println(centidegrees % 100);
 }
 void loop()
 {
-    SERIAL.println(String(convertRawAngleToDegrees(ams5600.getRawAngle()),DEC));
+    printRawAngleAsDegrees(ams5600.getRawAngle());
 }
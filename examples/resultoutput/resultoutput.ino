@@ -1,5 +1,4 @@
-#include <Wire.h>
-#include <AS5600.h>
+#include <AS5600_softwire.h>
 #ifdef ARDUINO_SAMD_VARIANT_COMPLIANCE
   #define SERIAL SerialUSB
   #define SYS_VOL   3.3
@@ -8,14 +7,14 @@
   #define SYS_VOL   5
 #endif
 
-AMS_5600 ams5600;
+// SDA on pin 2, SCL on pin 3, any free pins will do
+AMS_5600_SOFTWIRE ams5600(2, 3);
 
 int ang, lang = 0;
 
 void setup()
 {
   SERIAL.begin(115200);
-  Wire.begin();
   SERIAL.println(">>>>>>>>>>>>>>>>>>>>>>>>>>> ");
   if(ams5600.detectMagnet() == 0 ){
     while(1){
@@ -0,0 +1,48 @@
+#include <AS5600_bitbang.h>
+#include <AS5600_sampler.h>
+#ifdef ARDUINO_SAMD_VARIANT_COMPLIANCE
+  #define SERIAL SerialUSB
+#else
+  #define SERIAL Serial
+#endif
+
+// SDA on pin 2, SCL on pin 3
+typedef AMS_5600_BITBANG<2, 3> Encoder;
+Encoder ams5600;
+
+// 1 kHz samples, up to 64 waiting for loop()
+AS5600_Sampler<Encoder, 64> sampler(ams5600);
+
+// Timer1 compare match, one sample per tick
+ISR(TIMER1_COMPA_vect)
+{
+  sampler.tick();
+}
+
+void setup()
+{
+  SERIAL.begin(115200);
+  sampler.begin();
+  AS5600_Timer1::begin(1000);
+}
+
+void loop()
+{
+  AS5600_TimedSample sample;
+  while (sampler.read(sample)) {
+    if (sample.status != AS5600_OK)
+      continue;
+    SERIAL.print(sample.us);
+    SERIAL.print('\t');
+    SERIAL.println(sample.angle);
+  }
+
+  // printing at 115200 baud cannot keep up with 1 kHz, expect drops
+  static unsigned int reported = 0;
+  unsigned int dropped = sampler.dropped();
+  if (dropped != reported) {
+    SERIAL.print("dropped ");
+    SERIAL.println(dropped);
+    reported = dropped;
+  }
+}
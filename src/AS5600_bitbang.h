@@ -0,0 +1,561 @@
+/****************************************************
+  AMS 5600 direct-port bit-bang transport
+  File: AS5600_bitbang.h
+
+  Description:  AS5600_BitBangBus clocks the I2C bus
+  itself instead of going through SoftWire. Pins are
+  template parameters, so on AVR the port registers and
+  bit masks are compile-time constants and every SCL or
+  SDA edge compiles to a single sbi/cbi on the DDR
+  register. Lines are driven open-drain: PORT is kept
+  low and the pin is switched between output (low) and
+  input (released, pulled up).
+
+  Usage:
+    // SDA on pin 2, SCL on pin 3
+    AMS_5600_BITBANG<2, 3> ams5600;
+
+  Pin policy concept (static members):
+    begin()    configure the pin, line released
+    low()      drive the line low
+    release()  let the line float high
+    read()     current line level
+
+  Delay policy concept:
+    half()     wait half an SCL period
+
+  AS5600_timing_model.h provides host-side policies to
+  check the resulting edge sequence.
+***************************************************/
+
+#ifndef AS5600_BITBANG_h
+#define AS5600_BITBANG_h
+
+#include <Arduino.h>
+#include "AS5600_softwire.h"
+
+/*******************************************************
+  AVR pin: PINx, DDRx and PORTx live at consecutive
+  data space addresses, PinReg is the address of PINx.
+*******************************************************/
+template <uint16_t PinReg, uint8_t Bit>
+struct AS5600_AvrPin
+{
+  static const uint8_t mask = 1 << Bit;
+
+  static inline void begin()   { reg(PinReg + 2) &= ~mask; reg(PinReg + 1) &= ~mask; }
+  static inline void low()     { reg(PinReg + 1) |= mask; }
+  static inline void release() { reg(PinReg + 1) &= ~mask; }
+  static inline bool read()    { return reg(PinReg) & mask; }
+
+private:
+
+  static inline volatile uint8_t &reg(uint16_t addr) { return *(volatile uint8_t *)addr; }
+};
+
+/*******************************************************
+  Portable pin: compile-time pin number, generic
+  pinMode/digitalRead calls.
+*******************************************************/
+template <uint8_t Pin>
+struct AS5600_ArduinoPin
+{
+  static inline void begin()   { digitalWrite(Pin, LOW); pinMode(Pin, INPUT); }
+  static inline void low()     { pinMode(Pin, OUTPUT); digitalWrite(Pin, LOW); }
+  static inline void release() { pinMode(Pin, INPUT); }
+  static inline bool read()    { return digitalRead(Pin) == HIGH; }
+};
+
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega168__) || defined(__AVR_ATmega328__)
+// Uno/Nano pin numbers: 0-7 PORTD, 8-13 PORTB, 14-19 (A0-A5) PORTC
+constexpr uint16_t as5600_pinReg(uint8_t pin) { return pin < 8 ? 0x29 : (pin < 14 ? 0x23 : 0x26); }
+constexpr uint8_t as5600_pinBit(uint8_t pin)  { return pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14); }
+
+template <uint8_t Pin>
+struct AS5600_FastPin : AS5600_AvrPin<as5600_pinReg(Pin), as5600_pinBit(Pin)>
+{
+  static_assert(Pin < 20, "not a digital pin of this board");
+};
+#else
+// no compile-time pin table for this board, use AS5600_AvrPin directly on other AVRs
+template <uint8_t Pin>
+struct AS5600_FastPin : AS5600_ArduinoPin<Pin> {};
+#endif
+
+/*******************************************************
+  Half-period delays. Cycles are CPU cycles on AVR; on
+  other targets AS5600_MicrosDelay is the portable one.
+*******************************************************/
+template <unsigned long Cycles>
+struct AS5600_CycleDelay
+{
+  static inline void half()
+  {
+#if defined(__AVR__)
+    __builtin_avr_delay_cycles(Cycles);
+#else
+    for (volatile unsigned long i = 0; i < Cycles; i++)
+      ;
+#endif
+  }
+};
+
+template <unsigned int Us>
+struct AS5600_MicrosDelay
+{
+  static inline void half() { delayMicroseconds(Us); }
+};
+
+// default: 0.5 us per half period, meets fast-mode plus (1 MHz) timing
+#if defined(F_CPU)
+typedef AS5600_CycleDelay<(F_CPU + 1999999UL) / 2000000UL> AS5600_DefaultDelay;
+#else
+typedef AS5600_CycleDelay<8> AS5600_DefaultDelay;
+#endif
+
+template <class Sda, class Scl, class Delay = AS5600_DefaultDelay>
+class AS5600_BitBangBus
+{
+public:
+
+  AS5600_BitBangBus()
+    : _deadline(AS5600_DEFAULT_DEADLINE_US), _budget(0), _timedOut(false), _phase(A_IDLE)
+  {
+    Sda::begin();
+    Scl::begin();
+  }
+
+  /*******************************************************
+    Method: write
+    In: i2c address, data and byte count
+    Out: status of the transaction
+    Description: writes data in one transaction
+  *******************************************************/
+  AS5600_Status write(uint8_t addr, const uint8_t *data, uint8_t len)
+  {
+    if (_phase != A_IDLE)
+      return AS5600_BUSY;
+    begin();
+    bool ack = writeByte(addr << 1);
+    for (uint8_t i = 0; ack && (i < len); i++)
+      ack = writeByte(data[i]);
+    return end(ack);
+  }
+
+  /*******************************************************
+    Method: read
+    In: i2c address, buffer and byte count
+    Out: status of the transaction
+    Description: reads from the current device pointer,
+    every byte but the last is acknowledged
+  *******************************************************/
+  AS5600_Status read(uint8_t addr, uint8_t *data, uint8_t len)
+  {
+    if (_phase != A_IDLE)
+      return AS5600_BUSY;
+    begin();
+    bool ack = writeByte((addr << 1) | 1);
+    for (uint8_t i = 0; ack && (i < len) && !_timedOut; i++)
+      data[i] = readByte(i + 1 < len);
+    return end(ack);
+  }
+
+  /*******************************************************
+    Method: writeRead
+    In: i2c address, data to write, buffer to read into
+    Out: status of the transaction
+    Description: write phase followed by a read phase
+    after a repeated START, with a single STOP at the
+    end
+  *******************************************************/
+  AS5600_Status writeRead(uint8_t addr, const uint8_t *tx, uint8_t txLen,
+                          uint8_t *rx, uint8_t rxLen)
+  {
+    if (_phase != A_IDLE)
+      return AS5600_BUSY;
+    begin();
+    bool ack = writeByte(addr << 1);
+    for (uint8_t i = 0; ack && (i < txLen); i++)
+      ack = writeByte(tx[i]);
+    if (ack) {
+      restart();
+      ack = writeByte((addr << 1) | 1);
+      for (uint8_t i = 0; ack && (i < rxLen) && !_timedOut; i++)
+        rx[i] = readByte(i + 1 < rxLen);
+    }
+    return end(ack);
+  }
+
+  /*******************************************************
+    Method: setDeadline
+    In: deadline in microseconds
+    Out: none
+    Description: the engine only ever waits on a slave
+    stretching SCL. All stretching within a transaction
+    shares this budget, so a transaction takes at most
+    its fixed edge time plus the deadline.
+  *******************************************************/
+  void setDeadline(unsigned long us) { _deadline = us; }
+
+  /*******************************************************
+    Method: startWriteRead
+    In: i2c address, up to 2 bytes to write, buffer to
+        read into (either length may be 0)
+    Out: AS5600_OK if started, AS5600_BUSY if another
+         transfer is still running
+    Description: sets up a transfer that poll() then
+    clocks out a few steps at a time. tx is copied, rx
+    must stay valid until poll() reports completion.
+  *******************************************************/
+  AS5600_Status startWriteRead(uint8_t addr, const uint8_t *tx, uint8_t txLen,
+                               uint8_t *rx, uint8_t rxLen)
+  {
+    if ((_phase != A_IDLE) || (txLen > sizeof(_tx)))
+      return AS5600_BUSY;
+    _addr = addr;
+    for (uint8_t i = 0; i < txLen; i++)
+      _tx[i] = tx[i];
+    _txLen = txLen;
+    _rx = rx;
+    _rxLen = rxLen;
+    _reading = (txLen == 0);
+    _result = AS5600_OK;
+    _stretched = false;
+    _phase = A_START;
+    _sub = 0;
+    return AS5600_OK;
+  }
+
+  /*******************************************************
+    Method: poll
+    In: number of steps (half SCL periods) to run
+    Out: AS5600_BUSY while the transfer is running, its
+         final status once, AS5600_OK when idle
+    Description: every step is one line change preceded
+    by a half period delay, so the bus timing is never
+    tighter than the blocking path however often poll()
+    is called. A stretched clock does not block: the
+    step is retried on the next call until SCL has been
+    seen low for the deadline set with setDeadline().
+    Time spent between calls only counts while a device
+    holds SCL.
+  *******************************************************/
+  AS5600_Status poll(uint8_t steps)
+  {
+    if (_phase == A_IDLE)
+      return AS5600_OK;
+    while (steps-- && (_phase != A_DONE)) {
+      Delay::half();
+      if (!step())
+        break;
+    }
+    if (_phase != A_DONE)
+      return AS5600_BUSY;
+    _phase = A_IDLE;
+    return _result;
+  }
+
+  bool busy() const { return _phase != A_IDLE; }
+
+private:
+
+  unsigned long _deadline;
+  unsigned long _budget;
+  bool _timedOut;
+
+  // asynchronous transfer
+  enum Phase { A_IDLE, A_START, A_TX, A_RX, A_RESTART, A_STOP, A_DONE };
+
+  Phase _phase;
+  uint8_t _sub;           // step within the current bit
+  uint8_t _bit;           // bit within the current byte, 8 = ACK
+  uint8_t _byte;          // byte being shifted
+  uint8_t _index;         // byte within the current phase
+  bool _reading;          // false: write part, true: read part
+  uint8_t _addr;
+  uint8_t _tx[2];
+  uint8_t _txLen;
+  uint8_t *_rx;
+  uint8_t _rxLen;
+  AS5600_Status _result;
+  bool _stretched;        // SCL seen held low since _stretchStart
+  unsigned long _stretchStart;
+
+  // bus idle (both lines high) -> SDA falls while SCL high
+  void begin()
+  {
+    _budget = _deadline;
+    _timedOut = false;
+    Sda::low();
+    Delay::half();
+    Scl::low();
+  }
+
+  // SCL low -> SDA high, SCL high, then SDA falls while SCL high
+  void restart()
+  {
+    Sda::release();
+    Delay::half();
+    releaseScl();
+    Delay::half();
+    Sda::low();
+    Delay::half();
+    Scl::low();
+  }
+
+  // SCL low -> SDA rises while SCL high, then bus free time
+  AS5600_Status end(bool ack)
+  {
+    Sda::low();
+    Delay::half();
+    releaseScl();
+    Delay::half();
+    Sda::release();
+    Delay::half();
+    if (_timedOut)
+      return AS5600_TIMEOUT;
+    return ack ? AS5600_OK : AS5600_NACK;
+  }
+
+  // a device may hold SCL low, wait for it within the budget
+  inline void releaseScl()
+  {
+    Scl::release();
+    if (!Scl::read())
+      waitScl();
+  }
+
+  void waitScl()
+  {
+    if (_timedOut)
+      return;
+    unsigned long start = micros();
+    unsigned long waited = 0;
+    while (!Scl::read()) {
+      waited = micros() - start;
+      if (waited >= _budget) {
+        _timedOut = true;
+        _budget = 0;
+        return;
+      }
+    }
+    _budget -= waited;
+  }
+
+  // SDA changes only while SCL is low, returns true on ACK
+  bool writeByte(uint8_t data)
+  {
+    for (uint8_t bit = 0x80; bit; bit >>= 1) {
+      if (data & bit)
+        Sda::release();
+      else
+        Sda::low();
+      Delay::half();
+      releaseScl();
+      Delay::half();
+      Scl::low();
+    }
+    Sda::release();
+    Delay::half();
+    releaseScl();
+    Delay::half();
+    bool ack = !Sda::read();
+    Scl::low();
+    return ack && !_timedOut;
+  }
+
+  // samples SDA at the end of each SCL high phase
+  uint8_t readByte(bool ack)
+  {
+    uint8_t data = 0;
+    Sda::release();
+    for (uint8_t i = 0; i < 8; i++) {
+      Delay::half();
+      releaseScl();
+      Delay::half();
+      data = (data << 1) | (Sda::read() ? 1 : 0);
+      Scl::low();
+    }
+    if (ack)
+      Sda::low();
+    Delay::half();
+    releaseScl();
+    Delay::half();
+    Scl::low();
+    Sda::release();
+    return data;
+  }
+
+  // releases SCL, false while a device still holds it low
+  bool asyncReleaseScl()
+  {
+    Scl::release();
+    if (Scl::read()) {
+      _stretched = false;
+      return true;
+    }
+    if (!_stretched) {
+      _stretched = true;
+      _stretchStart = micros();
+    } else if (micros() - _stretchStart >= _deadline) {
+      _result = AS5600_TIMEOUT;
+      Sda::release();
+      _phase = A_DONE;
+    }
+    return false;
+  }
+
+  void asyncSendByte(uint8_t data)
+  {
+    _byte = data;
+    _bit = 0;
+    _sub = 0;
+    _phase = A_TX;
+  }
+
+  void asyncRestart()
+  {
+    _reading = true;
+    _sub = 0;
+    _phase = A_RESTART;
+  }
+
+  void asyncStop()
+  {
+    _sub = 0;
+    _phase = A_STOP;
+  }
+
+  // runs one step, false when it has to be retried later
+  bool step()
+  {
+    switch (_phase) {
+      case A_START:
+        if (_sub == 0) {
+          Sda::low();
+          _sub = 1;
+        } else {
+          Scl::low();
+          _index = 0;
+          asyncSendByte((_addr << 1) | (_reading ? 1 : 0));
+        }
+        break;
+
+      case A_TX:
+        if (_sub == 0) {
+          if ((_bit < 8) && !(_byte & (0x80 >> _bit)))
+            Sda::low();
+          else
+            Sda::release();
+          _sub = 1;
+        } else if (_sub == 1) {
+          if (!asyncReleaseScl())
+            return false;
+          _sub = 2;
+        } else if (_bit < 8) {
+          Scl::low();
+          _bit++;
+          _sub = 0;
+        } else {
+          bool ack = !Sda::read();
+          Scl::low();
+          if (!ack) {
+            _result = AS5600_NACK;
+            asyncStop();
+          } else if (_reading) {
+            if (_rxLen > 0) {
+              _index = 0;
+              _bit = 0;
+              _sub = 0;
+              _phase = A_RX;
+            } else {
+              asyncStop();
+            }
+          } else if (_index < _txLen) {
+            asyncSendByte(_tx[_index++]);
+          } else if (_rxLen > 0) {
+            asyncRestart();
+          } else {
+            asyncStop();
+          }
+        }
+        break;
+
+      case A_RX:
+        if (_bit < 8) {
+          if (_sub == 0) {
+            if (_bit == 0) {
+              Sda::release();
+              _byte = 0;
+            }
+            if (!asyncReleaseScl())
+              return false;
+            _sub = 1;
+          } else {
+            _byte = (_byte << 1) | (Sda::read() ? 1 : 0);
+            Scl::low();
+            _bit++;
+            _sub = 0;
+          }
+        } else {
+          if (_sub == 0) {
+            _rx[_index] = _byte;
+            if (_index + 1 < _rxLen)
+              Sda::low();
+            _sub = 1;
+          } else if (_sub == 1) {
+            if (!asyncReleaseScl())
+              return false;
+            _sub = 2;
+          } else {
+            Scl::low();
+            Sda::release();
+            _bit = 0;
+            _sub = 0;
+            if (++_index >= _rxLen)
+              asyncStop();
+          }
+        }
+        break;
+
+      case A_RESTART:
+        if (_sub == 0) {
+          Sda::release();
+          _sub = 1;
+        } else {
+          if (!asyncReleaseScl())
+            return false;
+          _sub = 0;
+          _phase = A_START;
+        }
+        break;
+
+      case A_STOP:
+        if (_sub == 0) {
+          Sda::low();
+          _sub = 1;
+        } else if (_sub == 1) {
+          if (!asyncReleaseScl())
+            return false;
+          _sub = 2;
+        } else if (_sub == 2) {
+          Sda::release();
+          _sub = 3;
+        } else {
+          // bus free time has passed
+          _phase = A_DONE;
+        }
+        break;
+
+      default:
+        break;
+    }
+    return true;
+  }
+};
+
+// driver on a compile-time pin pair
+template <uint8_t SdaPin, uint8_t SclPin, class Delay = AS5600_DefaultDelay>
+using AMS_5600_BITBANG = AMS_5600_Driver<AS5600_BitBangBus<AS5600_FastPin<SdaPin>, AS5600_FastPin<SclPin>, Delay> >;
+
+#endif
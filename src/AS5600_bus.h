@@ -0,0 +1,105 @@
+/****************************************************
+  AMS 5600 bus transports for Arduino platform
+  File: AS5600_bus.h
+
+  Description:  Transports the AMS_5600_Driver template
+  can be instantiated with. A transport is any class
+  providing the primitives below; the driver calls them
+  directly, so there is no virtual dispatch.
+
+    AS5600_Status write(uint8_t addr, const uint8_t *data, uint8_t len)
+      START, addr+W, data, STOP
+
+    AS5600_Status read(uint8_t addr, uint8_t *data, uint8_t len)
+      START, addr+R, data, STOP (no register address)
+
+    AS5600_Status writeRead(uint8_t addr, const uint8_t *tx, uint8_t txLen,
+                            uint8_t *rx, uint8_t rxLen)
+      START, addr+W, tx, repeated START, addr+R, rx, STOP
+
+    void setDeadline(unsigned long us)
+      upper bound on the time one transaction may spend
+      waiting on the bus, after which it gives up with
+      AS5600_TIMEOUT
+
+  Transports that can run a transfer in the background
+  also provide startWriteRead() and poll(), see
+  AS5600_BitBangBus.
+
+  AS5600_SoftWireBus   bit-banged, any two pins
+  AS5600_TwoWireBus    hardware I2C (AS5600_twowire.h)
+  AS5600_MockBus       in-memory device (AS5600_mock.h)
+  AS5600_BitBangBus    direct-port bit-bang (AS5600_bitbang.h)
+***************************************************/
+
+#ifndef AS5600_BUS_h
+#define AS5600_BUS_h
+
+#include <Arduino.h>
+#include <SoftWire.h>
+
+// outcome of a bus transaction
+enum AS5600_Status
+{
+  AS5600_OK = 0,
+  AS5600_NACK,       // address or data not acknowledged
+  AS5600_TIMEOUT,    // deadline passed while waiting on the bus
+  AS5600_SHORT_READ, // fewer bytes received than requested
+  AS5600_BUSY        // asynchronous transfer still in flight
+};
+
+// default per-transaction deadline in microseconds
+#define AS5600_DEFAULT_DEADLINE_US 1000
+
+// SoftWire buffer sizes, data bytes only (the address is not buffered). Only
+// write() and the bare read() go through the buffers; writeRead() does not.
+#define AS5600_TX_MAX 9  // register address + ZPOS..CONF 0x01-0x08
+#define AS5600_RX_MAX 2  // streamed read of a two byte register
+
+// longest register read burst the driver issues
+#define AS5600_BURST_MAX 18 // telemetry frame 0x0b-0x1c
+
+// SoftWire transport without buffers, see AS5600_SoftWireBus
+class AS5600_SoftWireCore
+{
+public:
+
+  AS5600_Status write(uint8_t addr, const uint8_t *data, uint8_t len);
+  AS5600_Status read(uint8_t addr, uint8_t *data, uint8_t len);
+  AS5600_Status writeRead(uint8_t addr, const uint8_t *tx, uint8_t txLen,
+                          uint8_t *rx, uint8_t rxLen);
+  void setDeadline(unsigned long us);
+
+  SoftWire sw;
+
+protected:
+
+  AS5600_SoftWireCore(uint8_t sdaPin, uint8_t sclPin,
+                      char *txBuffer, uint8_t txSize, char *rxBuffer, uint8_t rxSize);
+
+  // SoftWire keeps pointers to the buffers of this instance
+  AS5600_SoftWireCore(const AS5600_SoftWireCore &) = delete;
+  AS5600_SoftWireCore &operator=(const AS5600_SoftWireCore &) = delete;
+
+private:
+
+  uint8_t _txSize;
+  uint8_t _rxSize;
+};
+
+// bit-banged on any two pins, with SoftWire buffers sized for the bursts in use
+template <uint8_t TxCapacity = AS5600_TX_MAX, uint8_t RxCapacity = AS5600_RX_MAX>
+class AS5600_SoftWireBus : public AS5600_SoftWireCore
+{
+public:
+
+  AS5600_SoftWireBus(uint8_t sdaPin, uint8_t sclPin)
+    : AS5600_SoftWireCore(sdaPin, sclPin, swTxBuffer, TxCapacity, swRxBuffer, RxCapacity) {}
+
+private:
+
+  char swTxBuffer[TxCapacity];
+  char swRxBuffer[RxCapacity];
+};
+
+#endif
@@ -0,0 +1,145 @@
+/****************************************************
+  AMS 5600 commutation angle and sine/cosine
+  File: AS5600_commutation.h
+
+  Description:  For field-oriented control of a BLDC
+  motor with the AS5600 as rotor sensor. The electrical
+  angle is the raw angle times the number of pole
+  pairs, modulo one turn, and the current loop needs
+  its sine and cosine on every PWM cycle.
+
+  as5600_sin()/as5600_cos() take a 12-bit angle (4096
+  per turn) and return Q15 values (32767 is 1.0) from
+  a quarter-wave table of 129 entries, interpolated
+  linearly between entries 8 counts apart. The error is
+  within 1.2 LSB of the exact value scaled by 32767.
+  The table lives in flash (PROGMEM on AVR) and takes
+  258 bytes of it and no RAM. A lookup is a few
+  additions, one small multiplication and two table
+  reads.
+
+  Usage:
+    AS5600_Commutation rotor(7);        // 7 pole pairs
+    rotor.align(ams5600.getRawAngle()); // rotor held at electrical zero
+    rotor.read(ams5600);
+    int16_t s = rotor.sin(), c = rotor.cos();
+***************************************************/
+
+#ifndef AS5600_COMMUTATION_h
+#define AS5600_COMMUTATION_h
+
+#include <Arduino.h>
+#include "AS5600_bus.h"
+
+// sin(i * 90 / 128 degrees) * 32767, i = 0 to 128
+extern const int16_t as5600_sineTable[129] PROGMEM;
+
+/*******************************************************
+  sine of a 12-bit angle, Q15. The quadrant mirrors the
+  quarter-wave table and sets the sign.
+*******************************************************/
+inline int16_t as5600_sin(word angle)
+{
+  word quarter = angle & 0x03ff;
+  if (angle & 0x0400)
+    quarter = 0x0400 - quarter; // second and fourth quadrant run backwards
+  uint8_t index = quarter >> 3;
+  int16_t value = (int16_t)pgm_read_word(&as5600_sineTable[index]);
+  uint8_t fraction = quarter & 0x07;
+  if (fraction) {
+    int16_t next = (int16_t)pgm_read_word(&as5600_sineTable[index + 1]);
+    value += ((next - value) * fraction + 4) >> 3;
+  }
+  return (angle & 0x0800) ? -value : value;
+}
+
+// cosine of a 12-bit angle, Q15: the sine a quarter turn ahead
+inline int16_t as5600_cos(word angle)
+{
+  return as5600_sin(angle + 0x0400);
+}
+
+class AS5600_Commutation
+{
+public:
+
+  AS5600_Commutation(uint8_t polePairs = 1, word offset = 0)
+    : _polePairs(polePairs), _offset(offset & 0x0fff), _electrical(0),
+      _sin(0), _cos(32767) {}
+
+  void setPolePairs(uint8_t polePairs) { _polePairs = polePairs; }
+
+  // raw angle at which the electrical angle is zero
+  void setOffset(word offset) { _offset = offset & 0x0fff; }
+  word offset() const { return _offset; }
+
+  /*******************************************************
+    Method: align
+    In: raw angle with the rotor held at electrical zero
+    Out: none
+    Description: takes the current position as the
+    electrical zero, e.g. after driving a fixed current
+    vector into phase A.
+  *******************************************************/
+  void align(word rawAngle) { _offset = rawAngle & 0x0fff; }
+
+  /*******************************************************
+    Method: electricalAngle
+    In: raw angle
+    Out: electrical angle, 0 to 4095
+    Description: (raw angle - offset) * pole pairs
+    modulo one turn. The 16-bit product may wrap: 4096
+    divides 65536, so the low 12 bits stay right.
+  *******************************************************/
+  word electricalAngle(word rawAngle) const
+  {
+    return (word)((rawAngle - _offset) * _polePairs) & 0x0fff;
+  }
+
+  /*******************************************************
+    Method: update
+    In: raw angle
+    Out: electrical angle
+    Description: computes the electrical angle and its
+    sine and cosine.
+  *******************************************************/
+  word update(word rawAngle)
+  {
+    _electrical = electricalAngle(rawAngle);
+    _sin = as5600_sin(_electrical);
+    _cos = as5600_cos(_electrical);
+    return _electrical;
+  }
+
+  /*******************************************************
+    Method: read
+    In: driver to read the raw angle from
+    Out: status of the transaction
+    Description: reads the raw angle and updates; the
+    last angle is kept if the read failed.
+  *******************************************************/
+  template <class Driver>
+  AS5600_Status read(Driver &driver)
+  {
+    word rawAngle;
+    AS5600_Status status = driver.readRawAngle(rawAngle);
+    if (status == AS5600_OK)
+      update(rawAngle);
+    return status;
+  }
+
+  // results of the last update, angle 0 to 4095, sine and cosine Q15
+  word electrical() const { return _electrical; }
+  int16_t sin() const { return _sin; }
+  int16_t cos() const { return _cos; }
+
+private:
+
+  uint8_t _polePairs;
+  word _offset;
+  word _electrical;
+  int16_t _sin;
+  int16_t _cos;
+};
+
+#endif
@@ -0,0 +1,278 @@
+/****************************************************
+  AMS 5600 angle filters
+  File: AS5600_filters.h
+
+  Description:  Filters for raw angle samples that
+  know the angle wraps at 4096: plain arithmetic on
+  raw angles goes wrong at the 4095 to 0 boundary.
+  Integer only, constant memory.
+
+  AS5600_Oversampler averages 2^Log2Factor consecutive
+  samples into one with a 16-bit angle (65536 per
+  turn). Each sample is taken as the shortest signed
+  step from the first one of its block, so a block
+  straddling the wrap averages to the right place.
+  Averaging N samples of white noise adds about
+  log2(N) / 2 real bits.
+
+  AS5600_SpikeFilter drops physically impossible
+  single-sample jumps, e.g. from a bit-bang read upset
+  by noise, with a 3 or 5 sample median, and keeps a
+  glitch count and rate to alarm on.
+
+  Usage:
+    AS5600_Oversampler<4> average;      // 16 samples per result
+    ams5600.beginAngleStream();         // fast streamed reads
+    if (average.read(ams5600) == AS5600_OK)
+      word fine = average.angle16();
+
+    AS5600_SpikeFilter<3> clean(64);    // at most 64 counts per sample
+    clean.read(ams5600);                // re-reads an implausible sample once
+    word angle = clean.angle();
+***************************************************/
+
+#ifndef AS5600_FILTERS_h
+#define AS5600_FILTERS_h
+
+#include <Arduino.h>
+#include "AS5600_bus.h"
+
+template <uint8_t Log2Factor = 4>
+class AS5600_Oversampler
+{
+public:
+
+  static_assert(Log2Factor <= 8, "decimation factor must be 1 to 256");
+
+  enum { FACTOR = 1 << Log2Factor };
+
+  AS5600_Oversampler() : _result(0) { reset(); }
+
+  // drops a partly collected block
+  void reset()
+  {
+    _count = 0;
+    _sum = 0;
+  }
+
+  /*******************************************************
+    Method: add
+    In: raw angle
+    Out: true if this sample completed a block
+    Description: accumulates the step from the block's
+    first sample, -2048 to 2047. On completing a block
+    the result is updated and the next block starts.
+  *******************************************************/
+  bool add(word rawAngle)
+  {
+    rawAngle &= 0x0fff;
+    if (_count == 0)
+      _first = rawAngle;
+    else
+      _sum += (int)((rawAngle - _first + 2048) & 0x0fff) - 2048;
+    if (++_count < FACTOR)
+      return false;
+
+    // mean with 4 fraction bits, rounded, on top of the first sample
+    long mean = ((_sum << 4) + (FACTOR >> 1)) >> Log2Factor;
+    _result = ((word)_first << 4) + (word)mean;
+    reset();
+    return true;
+  }
+
+  /*******************************************************
+    Method: read
+    In: driver to read raw angles from
+    Out: status of the first failed transaction, or OK
+    Description: reads a whole block back to back and
+    updates the result. After beginAngleStream() on the
+    driver each read is a bare 2 byte read. A failed
+    read drops the block and leaves the result alone.
+  *******************************************************/
+  template <class Driver>
+  AS5600_Status read(Driver &driver)
+  {
+    reset();
+    for (uint16_t i = 0; i < FACTOR; i++) {
+      word rawAngle;
+      AS5600_Status status = driver.readRawAngle(rawAngle);
+      if (status != AS5600_OK) {
+        reset();
+        return status;
+      }
+      add(rawAngle);
+    }
+    return AS5600_OK;
+  }
+
+  // last result, 65536 per turn
+  word angle16() const { return _result; }
+
+  // last result rounded to 12 bits, 0 to 4095
+  word angle() const { return ((_result + 8) >> 4) & 0x0fff; }
+
+private:
+
+  word _first;
+  long _sum;       // of steps from _first, within +-2^19
+  uint16_t _count; // samples in the current block
+  word _result;
+};
+
+/*******************************************************
+  Glitch rejection for links without a checksum. A
+  sample whose step from the filtered angle exceeds the
+  maximum slew is implausible and counted as a glitch.
+  The output is the median of the last Size samples
+  (3 or 5), taken as steps from the filtered angle so
+  the wrap does not matter: a lone spike never reaches
+  the output, while a real jump does once it makes up
+  the majority of the window.
+*******************************************************/
+template <uint8_t Size = 3>
+class AS5600_SpikeFilter
+{
+public:
+
+  static_assert((Size == 3) || (Size == 5), "median window must be 3 or 5");
+
+  // maxSlew: largest plausible step in counts per sample
+  AS5600_SpikeFilter(word maxSlew = 256)
+    : _maxSlew(maxSlew), _rereads(1), _head(0), _output(0)
+  {
+    reset();
+    resetStats();
+  }
+
+  // starts over, the next sample fills the whole window
+  void reset() { _started = false; }
+
+  void resetStats()
+  {
+    _samples = 0;
+    _glitches = 0;
+    _rate = 0;
+  }
+
+  void setMaxSlew(word counts) { _maxSlew = counts; }
+
+  // extra reads read() may take in place of an implausible sample, 0 for none
+  void setRereads(uint8_t rereads) { _rereads = rereads; }
+
+  // true if rawAngle is within the maximum slew of the filtered angle
+  bool plausible(word rawAngle) const
+  {
+    if (!_started)
+      return true;
+    int step = stepFrom(_output, rawAngle);
+    return (step <= (int)_maxSlew) && (step >= -(int)_maxSlew);
+  }
+
+  /*******************************************************
+    Method: add
+    In: raw angle
+    Out: false if the sample was a glitch
+    Description: checks the sample, counts it, and
+    updates the median of the window.
+  *******************************************************/
+  bool add(word rawAngle)
+  {
+    rawAngle &= 0x0fff;
+    if (!_started) {
+      for (uint8_t i = 0; i < Size; i++)
+        _window[i] = rawAngle;
+      _head = 0;
+      _output = rawAngle;
+      _started = true;
+      countSample(false);
+      return true;
+    }
+
+    bool good = plausible(rawAngle);
+    countSample(!good);
+
+    _head = (_head + 1 < Size) ? _head + 1 : 0;
+    _window[_head] = rawAngle;
+
+    int steps[Size];
+    for (uint8_t i = 0; i < Size; i++) {
+      int step = stepFrom(_output, _window[i]);
+      uint8_t j = i;
+      for (; (j > 0) && (steps[j - 1] > step); j--)
+        steps[j] = steps[j - 1];
+      steps[j] = step;
+    }
+    _output = (_output + steps[Size / 2]) & 0x0fff;
+    return good;
+  }
+
+  /*******************************************************
+    Method: read
+    In: driver to read the raw angle from
+    Out: status of the transaction
+    Description: reads the raw angle; while it is
+    implausible, reads again up to the re-read limit,
+    counting each replaced sample as a glitch. A failed
+    re-read stops there. The last sample read goes
+    through add(), so every sample is counted once.
+    Nothing changes if the first read failed.
+  *******************************************************/
+  template <class Driver>
+  AS5600_Status read(Driver &driver)
+  {
+    word rawAngle;
+    AS5600_Status status = driver.readRawAngle(rawAngle);
+    if (status != AS5600_OK)
+      return status;
+    for (uint8_t i = 0; (i < _rereads) && !plausible(rawAngle); i++) {
+      word again;
+      if (driver.readRawAngle(again) != AS5600_OK)
+        break;
+      countSample(true); // the sample it replaces
+      rawAngle = again;
+    }
+    add(rawAngle);
+    return AS5600_OK;
+  }
+
+  // filtered raw angle, 0 to 4095
+  word angle() const { return _output; }
+
+  unsigned long samples() const { return _samples; }
+  unsigned long glitches() const { return _glitches; }
+
+  // share of recent samples that were glitches, 65535 is all of them,
+  // averaged with a time constant of about 256 samples
+  word glitchRate() const { return _rate; }
+
+private:
+
+  word _maxSlew;
+  uint8_t _rereads;
+  bool _started;
+  word _window[Size];
+  uint8_t _head;   // slot of the newest sample
+  word _output;
+  unsigned long _samples;
+  unsigned long _glitches;
+  word _rate;
+
+  // shortest signed step from one raw angle to another, -2048 to 2047
+  static int stepFrom(word from, word to)
+  {
+    return (int)((to - from + 2048) & 0x0fff) - 2048;
+  }
+
+  void countSample(bool glitch)
+  {
+    _samples++;
+    long target = 0;
+    if (glitch) {
+      _glitches++;
+      target = 65535;
+    }
+    _rate += (target - (long)_rate) >> 8;
+  }
+};
+
+#endif
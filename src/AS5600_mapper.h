@@ -0,0 +1,148 @@
+/****************************************************
+  AMS 5600 software zero and range mapping
+  File: AS5600_mapper.h
+
+  Description:  AS5600_Mapper does what ZPOS and MPOS
+  do on the chip, on the raw angle read by the host:
+  the angle is taken relative to a start position and
+  stretched over a range, so moving the zero or the
+  range costs no bus traffic and no burn cycles, and a
+  scaled reading is one raw angle read.
+
+  Positions outside the range clamp to the nearer end,
+  the dead zone being split in the middle. Setting a
+  range divides once; mapping a sample multiplies by
+  the precomputed reciprocal and gives exactly
+  floor(offset * fullScale / span), without division.
+
+  Usage:
+    AS5600_Mapper mapper;                 // 0 to 4095 like the ANGLE register
+    mapper.setRange(1024, 3072);          // half a turn
+    word scaled = mapper.map(ams5600.getRawAngle());
+    mapper.setZero(ams5600.getRawAngle()); // re-zero here, same span
+***************************************************/
+
+#ifndef AS5600_MAPPER_h
+#define AS5600_MAPPER_h
+
+#include <Arduino.h>
+#include "AS5600_bus.h"
+#include "AS5600_units.h"
+
+class AS5600_Mapper
+{
+public:
+
+  // fullScale: output steps over the range, 1 to 65535
+  AS5600_Mapper(word fullScale = AS5600_COUNTS_PER_TURN)
+    : _start(0), _span(AS5600_COUNTS_PER_TURN), _fullScale(fullScale)
+  {
+    updateScale();
+  }
+
+  /*******************************************************
+    Method: setRange
+    In: start and end raw angles
+    Out: none
+    Description: maps start..end, counted upwards across
+    the wrap if end < start. start == end is the whole
+    turn, as with ZPOS == MPOS on the chip.
+  *******************************************************/
+  void setRange(word start, word end)
+  {
+    _start = start & (AS5600_COUNTS_PER_TURN - 1);
+    _span = (end - start) & (AS5600_COUNTS_PER_TURN - 1);
+    if (_span == 0)
+      _span = AS5600_COUNTS_PER_TURN;
+    updateScale();
+  }
+
+  // moves the start to rawAngle, keeping the span
+  void setZero(word rawAngle) { _start = rawAngle & (AS5600_COUNTS_PER_TURN - 1); }
+
+  void setFullScale(word fullScale)
+  {
+    _fullScale = fullScale;
+    updateScale();
+  }
+
+  word start() const { return _start; }
+  word end() const { return (_start + _span) & (AS5600_COUNTS_PER_TURN - 1); }
+  word span() const { return _span; }
+
+  /*******************************************************
+    Method: offset
+    In: raw angle
+    Out: counts past the start, 0 to span - 1
+    Description: positions in the dead zone past the end
+    clamp to span - 1 up to its middle and to 0 beyond.
+  *******************************************************/
+  word offset(word rawAngle) const
+  {
+    word offset = (rawAngle - _start) & (AS5600_COUNTS_PER_TURN - 1);
+    if (offset >= _span) {
+      word past = offset - _span;
+      offset = (past < (AS5600_COUNTS_PER_TURN - _span) / 2) ? _span - 1 : 0;
+    }
+    return offset;
+  }
+
+  /*******************************************************
+    Method: map
+    In: raw angle
+    Out: 0 to fullScale - 1
+    Description: offset * fullScale / span as
+    offset * ceil(fullScale * 2^24 / span) >> 24. The
+    reciprocal exceeds the exact one by less than 1, so
+    the product exceeds the exact quotient by less than
+    span / 2^24, smaller than the 1 / span step between
+    quotients: the floor is exact. The multiplier is
+    split in 16-bit halves to keep the products in 32
+    bits.
+  *******************************************************/
+  word map(word rawAngle) const
+  {
+    uint32_t offset = this->offset(rawAngle);
+    return (offset * _scaleHigh + ((offset * _scaleLow) >> 16)) >> 8;
+  }
+
+  // counts past the start in centidegrees, e.g. for display
+  word centidegrees(word rawAngle) const
+  {
+    return as5600_toCentidegrees(offset(rawAngle));
+  }
+
+  /*******************************************************
+    Method: read
+    In: driver to read the raw angle from, mapped result
+    Out: status of the transaction
+    Description: one raw angle read, mapped; value is
+    left alone if the read failed.
+  *******************************************************/
+  template <class Driver>
+  AS5600_Status read(Driver &driver, word &value)
+  {
+    word rawAngle;
+    AS5600_Status status = driver.readRawAngle(rawAngle);
+    if (status == AS5600_OK)
+      value = map(rawAngle);
+    return status;
+  }
+
+private:
+
+  word _start;
+  word _span;      // 1 to 4096
+  word _fullScale;
+  uint32_t _scaleHigh; // ceil(fullScale * 2^24 / span), bits 16 and up
+  uint16_t _scaleLow;  // and bits 0 to 15
+
+  void updateScale()
+  {
+    uint64_t scale = (((uint64_t)_fullScale << 24) + _span - 1) / _span;
+    _scaleHigh = scale >> 16;
+    _scaleLow = scale & 0xffff;
+  }
+};
+
+#endif
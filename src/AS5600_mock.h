@@ -0,0 +1,107 @@
+/****************************************************
+  AMS 5600 in-memory transport
+  File: AS5600_mock.h
+
+  Description:  AS5600_MockBus emulates the register
+  file and address pointer of an AS5600, including the
+  suppressed auto-increment on the high byte of ANGLE,
+  RAW ANGLE and MAGNITUDE (datasheet page 13). It
+  counts transactions and bytes on the wire so sketches
+  and host builds can check what a driver call costs,
+  and can be told to NACK, time out or come up short.
+  A writeRead counts as one transaction, as it is one
+  on the wire.
+
+  Usage:
+    AMS_5600_Driver<AS5600_MockBus> ams5600;
+    ams5600.bus.regs[0x0c] = 0x08;
+***************************************************/
+
+#ifndef AS5600_MOCK_h
+#define AS5600_MOCK_h
+
+#include <Arduino.h>
+#include "AS5600_bus.h"
+
+class AS5600_MockBus
+{
+public:
+
+  AS5600_MockBus()
+    : pointer(0), present(true), readLimit(255), stalled(false),
+      deadline(AS5600_DEFAULT_DEADLINE_US), transactions(0), bytesOnWire(0)
+  {
+    for (int i = 0; i < 256; i++)
+      regs[i] = 0;
+  }
+
+  AS5600_Status write(uint8_t addr, const uint8_t *data, uint8_t len)
+  {
+    transactions++;
+    bytesOnWire += 1 + len;
+    if (stalled)
+      return AS5600_TIMEOUT;
+    if (!present)
+      return AS5600_NACK;
+    (void)addr;
+    if (len > 0)
+      pointer = data[0];
+    for (uint8_t i = 1; i < len; i++)
+      regs[pointer++] = data[i];
+    return AS5600_OK;
+  }
+
+  AS5600_Status read(uint8_t addr, uint8_t *data, uint8_t len)
+  {
+    transactions++;
+    bytesOnWire += 1;
+    if (stalled)
+      return AS5600_TIMEOUT;
+    if (!present)
+      return AS5600_NACK;
+    (void)addr;
+    uint8_t count = len < readLimit ? len : readLimit;
+    // a re-read of a non-incrementing register starts again from its high byte
+    uint8_t start = pointer;
+    for (uint8_t i = 0; i < count; i++) {
+      data[i] = regs[pointer];
+      if (holdsPointer(start) && (pointer == start + 1))
+        pointer = start;
+      else
+        pointer++;
+    }
+    bytesOnWire += count;
+    return count < len ? AS5600_SHORT_READ : AS5600_OK;
+  }
+
+  // one transaction with a repeated START: the address goes out twice
+  AS5600_Status writeRead(uint8_t addr, const uint8_t *tx, uint8_t txLen,
+                          uint8_t *rx, uint8_t rxLen)
+  {
+    AS5600_Status status = write(addr, tx, txLen);
+    if (status != AS5600_OK)
+      return status;
+    transactions--;
+    return read(addr, rx, rxLen);
+  }
+
+  void setDeadline(unsigned long us) { deadline = us; }
+
+  uint8_t regs[256];
+  uint8_t pointer;
+  bool present;           // false: every transaction is NACKed
+  uint8_t readLimit;      // bytes delivered per read before it comes up short
+  bool stalled;           // true: every transaction times out
+  unsigned long deadline;
+  unsigned long transactions;
+  unsigned long bytesOnWire;
+
+private:
+
+  static bool holdsPointer(uint8_t reg)
+  {
+    return (reg == 0x0c) || (reg == 0x0e) || (reg == 0x1b);
+  }
+};
+
+#endif
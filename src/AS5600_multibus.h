@@ -0,0 +1,343 @@
+/****************************************************
+  AMS 5600 parallel multi-bus bit-bang engine
+  File: AS5600_multibus.h
+
+  Description:  Every AS5600 answers at 0x36, so several
+  sensors need one bus each. AS5600_MultiBus puts up to
+  8 of those buses on one port: SCL is shared, each
+  sensor has its own SDA line on the port. All buses
+  are clocked in lockstep, the same address and register
+  bytes go out on every SDA line at once, and each read
+  bit of all sensors is sampled with a single port read.
+  Reading N sensors costs about one read, and all
+  angles are taken at the same instant.
+
+  Usage:
+    // SCL on pin 8, SDA of four sensors on PD4..PD7
+    AS5600_MultiBus<AS5600_PortD, 0xf0, AS5600_FastPin<8> > encoders;
+    word angles[4];
+    uint8_t ok = encoders.readRawAngles(angles);
+
+  Port policy concept (static members):
+    begin(mask)    configure the lines, released
+    low(mask)      drive the lines low
+    release(mask)  let the lines float high
+    read()         levels of the whole port
+
+  Results are indexed by line in increasing bit order:
+  index 0 is the lowest bit set in SdaMask. Methods
+  return a mask of the lines that completed, in the same
+  bit positions as SdaMask.
+***************************************************/
+
+#ifndef AS5600_MULTIBUS_h
+#define AS5600_MULTIBUS_h
+
+#include <Arduino.h>
+#include "AS5600_bitbang.h"
+
+/*******************************************************
+  AVR port: PINx, DDRx and PORTx at consecutive data
+  space addresses, PinReg is the address of PINx.
+*******************************************************/
+template <uint16_t PinReg>
+struct AS5600_AvrPort
+{
+  static inline void begin(uint8_t mask)   { reg(PinReg + 2) &= ~mask; reg(PinReg + 1) &= ~mask; }
+  static inline void low(uint8_t mask)     { reg(PinReg + 1) |= mask; }
+  static inline void release(uint8_t mask) { reg(PinReg + 1) &= ~mask; }
+  static inline uint8_t read()             { return reg(PinReg); }
+
+private:
+
+  static inline volatile uint8_t &reg(uint16_t addr) { return *(volatile uint8_t *)addr; }
+};
+
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega168__) || defined(__AVR_ATmega328__)
+typedef AS5600_AvrPort<0x23> AS5600_PortB; // pins 8-13
+typedef AS5600_AvrPort<0x26> AS5600_PortC; // pins A0-A5
+typedef AS5600_AvrPort<0x29> AS5600_PortD; // pins 0-7
+#endif
+
+constexpr uint8_t as5600_bitCount(uint8_t mask)
+{
+  return mask ? (mask & 1) + as5600_bitCount(mask >> 1) : 0;
+}
+
+template <class SdaPort, uint8_t SdaMask, class Scl, class Delay = AS5600_DefaultDelay>
+class AS5600_MultiBus
+{
+public:
+
+  static const uint8_t count = as5600_bitCount(SdaMask);
+
+  static_assert(SdaMask != 0, "no SDA line selected");
+
+  AS5600_MultiBus()
+    : _deadline(AS5600_DEFAULT_DEADLINE_US), _budget(0), _timedOut(false), _pointer(-1), _streamReg(-1)
+  {
+    SdaPort::begin(SdaMask);
+    Scl::begin();
+  }
+
+  /*******************************************************
+    Method: write
+    In: bytes to send on every bus
+    Out: mask of the lines that acknowledged every byte
+    Description: one transaction on all buses at once.
+  *******************************************************/
+  uint8_t write(const uint8_t *data, uint8_t len)
+  {
+    begin();
+    uint8_t acked = writeByte(_ams5600_Address << 1);
+    for (uint8_t i = 0; acked && (i < len); i++)
+      acked &= writeByte(data[i]);
+    end();
+    _pointer = -1;
+    return _timedOut ? 0 : acked;
+  }
+
+  /*******************************************************
+    Method: read
+    In: byte count, buffer of count * len bytes
+    Out: mask of the lines that acknowledged the address
+    Description: reads len bytes from the current pointer
+    of every device. Bytes of line i are stored at
+    data[i * len]. Lines that did not answer read 0xff.
+  *******************************************************/
+  uint8_t read(uint8_t *data, uint8_t len)
+  {
+    begin();
+    uint8_t acked = writeByte((_ams5600_Address << 1) | 1);
+    for (uint8_t i = 0; acked && (i < len) && !_timedOut; i++) {
+      uint8_t samples[8];
+      readByte(samples, i + 1 < len);
+      spread(samples, data + i, len);
+    }
+    end();
+    return _timedOut ? 0 : acked;
+  }
+
+  /*******************************************************
+    Method: writeRead
+    In: bytes to send on every bus, buffer of
+        count * rxLen bytes
+    Out: mask of the lines that acknowledged every byte
+    Description: write phase and, after a repeated START,
+    read phase on all buses at once. Only lines that
+    acknowledged the write part are read. Bytes are
+    stored as in read().
+  *******************************************************/
+  uint8_t writeRead(const uint8_t *tx, uint8_t txLen, uint8_t *rx, uint8_t rxLen)
+  {
+    begin();
+    uint8_t acked = writeByte(_ams5600_Address << 1);
+    for (uint8_t i = 0; acked && (i < txLen); i++)
+      acked &= writeByte(tx[i]);
+    _pointer = -1;
+    if (acked && !_timedOut) {
+      restart();
+      acked &= writeByte((_ams5600_Address << 1) | 1);
+      for (uint8_t i = 0; acked && (i < rxLen) && !_timedOut; i++) {
+        uint8_t samples[8];
+        readByte(samples, i + 1 < rxLen);
+        spread(samples, rx + i, rxLen);
+      }
+    }
+    end();
+    return _timedOut ? 0 : acked;
+  }
+
+  /*******************************************************
+    Method: readTwoBytes
+    In: register, one word per line
+    Out: mask of the lines read successfully
+    Description: reads a two byte register of every
+    sensor. Honours streaming mode like the single
+    driver: a streamed register skips the address write,
+    but only while every line is known to hold the
+    pointer. Lines that missed the pointer write are
+    left out of the mask.
+  *******************************************************/
+  uint8_t readTwoBytes(uint8_t reg, word values[])
+  {
+    uint8_t data[2 * count];
+    uint8_t acked;
+    if ((_streamReg == -1) || (_pointer != reg))
+      acked = writeRead(&reg, 1, data, 2);
+    else
+      acked = read(data, 2);
+
+    // a line that missed this transfer may have lost its pointer,
+    // e.g. after a reset, so the next read writes it again
+    if (acked != SdaMask)
+      _pointer = -1;
+    if (!acked)
+      return 0;
+
+    for (uint8_t i = 0; i < count; i++)
+      values[i] = (data[2 * i] << 8) | data[2 * i + 1];
+
+    if (((reg == _addr_raw_angle) || (reg == _addr_angle) || (reg == _addr_magnitude)) &&
+        (acked == SdaMask))
+      _pointer = reg;
+    return acked;
+  }
+
+  uint8_t readRawAngles(word angles[])    { return readTwoBytes(_addr_raw_angle, angles); }
+  uint8_t readScaledAngles(word angles[]) { return readTwoBytes(_addr_angle, angles); }
+  uint8_t readMagnitudes(word values[])   { return readTwoBytes(_addr_magnitude, values); }
+
+  /*******************************************************
+    Method: beginAngleStream
+    In: register to stream (raw angle, angle or magnitude)
+    Out: mask of the lines that acknowledged
+    Description: as AMS_5600_Driver::beginAngleStream, for
+    all buses. Unless every line acknowledged, the first
+    streamed read still sends the address write, and
+    streaming starts once all lines have taken it.
+  *******************************************************/
+  uint8_t beginAngleStream(uint8_t reg = _addr_raw_angle)
+  {
+    uint8_t acked = write(&reg, 1);
+    _pointer = (acked == SdaMask) ? reg : -1;
+    _streamReg = reg;
+    return acked;
+  }
+
+  void endAngleStream()
+  {
+    _streamReg = -1;
+    _pointer = -1;
+  }
+
+  void setDeadline(unsigned long us) { _deadline = us; }
+
+private:
+
+  static const uint8_t _ams5600_Address = 0x36;
+  static const uint8_t _addr_raw_angle  = 0x0c;
+  static const uint8_t _addr_angle      = 0x0e;
+  static const uint8_t _addr_magnitude  = 0x1b;
+
+  unsigned long _deadline;
+  unsigned long _budget;
+  bool _timedOut;
+  int _pointer;
+  int _streamReg;
+
+  void begin()
+  {
+    _budget = _deadline;
+    _timedOut = false;
+    SdaPort::low(SdaMask);
+    Delay::half();
+    Scl::low();
+  }
+
+  // repeated START, SCL low on entry
+  void restart()
+  {
+    SdaPort::release(SdaMask);
+    Delay::half();
+    releaseScl();
+    Delay::half();
+    SdaPort::low(SdaMask);
+    Delay::half();
+    Scl::low();
+  }
+
+  void end()
+  {
+    SdaPort::low(SdaMask);
+    Delay::half();
+    releaseScl();
+    Delay::half();
+    SdaPort::release(SdaMask);
+    Delay::half();
+  }
+
+  // any device may stretch the shared clock, bounded like AS5600_BitBangBus
+  inline void releaseScl()
+  {
+    Scl::release();
+    if (!Scl::read())
+      waitScl();
+  }
+
+  void waitScl()
+  {
+    if (_timedOut)
+      return;
+    unsigned long start = micros();
+    unsigned long waited = 0;
+    while (!Scl::read()) {
+      waited = micros() - start;
+      if (waited >= _budget) {
+        _timedOut = true;
+        _budget = 0;
+        return;
+      }
+    }
+    _budget -= waited;
+  }
+
+  // same byte on every line, returns the lines that ACKed
+  uint8_t writeByte(uint8_t data)
+  {
+    for (uint8_t bit = 0x80; bit; bit >>= 1) {
+      if (data & bit)
+        SdaPort::release(SdaMask);
+      else
+        SdaPort::low(SdaMask);
+      Delay::half();
+      releaseScl();
+      Delay::half();
+      Scl::low();
+    }
+    SdaPort::release(SdaMask);
+    Delay::half();
+    releaseScl();
+    Delay::half();
+    uint8_t acked = ~SdaPort::read() & SdaMask;
+    Scl::low();
+    return acked;
+  }
+
+  // one port snapshot per bit, MSB first
+  void readByte(uint8_t samples[8], bool ack)
+  {
+    SdaPort::release(SdaMask);
+    for (uint8_t i = 0; i < 8; i++) {
+      Delay::half();
+      releaseScl();
+      Delay::half();
+      samples[i] = SdaPort::read();
+      Scl::low();
+    }
+    if (ack)
+      SdaPort::low(SdaMask);
+    Delay::half();
+    releaseScl();
+    Delay::half();
+    Scl::low();
+    SdaPort::release(SdaMask);
+  }
+
+  // turns 8 port snapshots into one byte per line, outside the clocked part
+  static void spread(const uint8_t samples[8], uint8_t *data, uint8_t stride)
+  {
+    uint8_t line = 0;
+    for (uint8_t mask = 1; mask; mask <<= 1) {
+      if (!(SdaMask & mask))
+        continue;
+      uint8_t value = 0;
+      for (uint8_t i = 0; i < 8; i++)
+        value = (value << 1) | ((samples[i] & mask) ? 1 : 0);
+      data[line * stride] = value;
+      line++;
+    }
+  }
+};
+
+#endif
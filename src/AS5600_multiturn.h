@@ -0,0 +1,129 @@
+/****************************************************
+  AMS 5600 multi-turn position tracker
+  File: AS5600_multiturn.h
+
+  Description:  The raw angle wraps every revolution.
+  AS5600_MultiTurn unwraps it into a continuous count,
+  4096 counts per turn, taking the shortest path
+  between two readings: the shaft is assumed to have
+  turned less than half a revolution since the last
+  one. A step close to half a turn may just as well
+  have gone the other way, so such steps are flagged
+  as suspicious; they mean the sample rate is too low
+  for the shaft speed. Integer only, cheap enough for
+  every sample on an 8-bit MCU.
+
+  Usage:
+    AS5600_MultiTurn<> position;           // 32 bit count
+    AS5600_MultiTurn<long long> odometer;  // 64 bit count
+    position.read(ams5600);
+    long counts = position.position();
+***************************************************/
+
+#ifndef AS5600_MULTITURN_h
+#define AS5600_MULTITURN_h
+
+#include <Arduino.h>
+#include "AS5600_bus.h"
+#include "AS5600_units.h"
+
+template <class Position = long>
+class AS5600_MultiTurn
+{
+public:
+
+  // default: steps of 3/8 turn or more are suspicious
+  AS5600_MultiTurn(word suspiciousStep = AS5600_COUNTS_PER_TURN * 3 / 8)
+    : _position(0), _last(0), _started(false), _suspicious(false),
+      _suspiciousStep(suspiciousStep), _suspiciousCount(0) {}
+
+  /*******************************************************
+    Method: reset
+    In: current raw angle, whole turns to start from
+    Out: none
+    Description: restarts tracking at turns * 4096 +
+    rawAngle.
+  *******************************************************/
+  void reset(word rawAngle, long turns = 0)
+  {
+    _last = rawAngle & (AS5600_COUNTS_PER_TURN - 1);
+    _position = (Position)turns * AS5600_COUNTS_PER_TURN + _last;
+    _started = true;
+    _suspicious = false;
+  }
+
+  /*******************************************************
+    Method: update
+    In: raw angle
+    Out: false if the step was suspicious
+    Description: adds the shortest signed step from the
+    previous raw angle, -2048 to 2047 counts. The first
+    call after construction starts tracking.
+  *******************************************************/
+  bool update(word rawAngle)
+  {
+    rawAngle &= AS5600_COUNTS_PER_TURN - 1;
+    if (!_started) {
+      reset(rawAngle);
+      return true;
+    }
+
+    int delta = (rawAngle - _last) & (AS5600_COUNTS_PER_TURN - 1);
+    if (delta >= AS5600_COUNTS_PER_TURN / 2)
+      delta -= AS5600_COUNTS_PER_TURN;
+    _position += delta;
+    _last = rawAngle;
+
+    word step = delta < 0 ? -delta : delta;
+    _suspicious = step >= _suspiciousStep;
+    if (_suspicious)
+      _suspiciousCount++;
+    return !_suspicious;
+  }
+
+  /*******************************************************
+    Method: read
+    In: driver to read the raw angle from
+    Out: status of the transaction
+    Description: reads the raw angle and updates the
+    position; nothing changes if the read failed.
+  *******************************************************/
+  template <class Driver>
+  AS5600_Status read(Driver &driver)
+  {
+    word rawAngle;
+    AS5600_Status status = driver.readRawAngle(rawAngle);
+    if (status == AS5600_OK)
+      update(rawAngle);
+    return status;
+  }
+
+  // continuous position in counts
+  Position position() const { return _position; }
+
+  // whole turns, the raw angle is the fraction on top
+  Position turns() const
+  {
+    return (_position - (Position)_last) / AS5600_COUNTS_PER_TURN;
+  }
+
+  // raw angle of the last update, 0 to 4095
+  word angle() const { return _last; }
+
+  // last step was close to half a turn, a wrap may have been missed
+  bool suspicious() const { return _suspicious; }
+  unsigned long suspiciousCount() const { return _suspiciousCount; }
+
+  void setSuspiciousStep(word counts) { _suspiciousStep = counts; }
+
+private:
+
+  Position _position;
+  word _last;
+  bool _started;
+  bool _suspicious;
+  word _suspiciousStep;
+  unsigned long _suspiciousCount;
+};
+
+#endif
@@ -0,0 +1,71 @@
+/****************************************************
+  AMS 5600 register map
+  File: AS5600_registers.h
+
+  Description:  One constexpr descriptor per AS5600
+  register: address of the high byte, width in bytes,
+  mask of the implemented bits, and whether the
+  register holds the address pointer on reads instead
+  of auto-incrementing (datasheet page 13). The driver's
+  readRegisters() plans its bursts from this table.
+
+  Usage:
+    const AS5600_Register regs[] = { AS5600_STATUS, AS5600_RAW_ANGLE, AS5600_AGC };
+    word values[3];
+    ams5600.readRegisters(regs, values);
+***************************************************/
+
+#ifndef AS5600_REGISTERS_h
+#define AS5600_REGISTERS_h
+
+#include <Arduino.h>
+
+enum AS5600_Register
+{
+  AS5600_ZMCO = 0,
+  AS5600_ZPOS,
+  AS5600_MPOS,
+  AS5600_MANG,
+  AS5600_CONF,
+  AS5600_STATUS,
+  AS5600_RAW_ANGLE,
+  AS5600_ANGLE,
+  AS5600_AGC,
+  AS5600_MAGNITUDE,
+  AS5600_REGISTER_COUNT
+};
+
+struct AS5600_RegisterInfo
+{
+  uint8_t addr;      // address, high byte first for two byte registers
+  uint8_t width;     // bytes
+  word mask;         // implemented bits
+  bool holdsPointer; // reads addressed here do not auto-increment
+};
+
+// indexed by AS5600_Register
+constexpr AS5600_RegisterInfo as5600_registerMap[AS5600_REGISTER_COUNT] = {
+  { 0x00, 1, 0x0003, false }, // ZMCO
+  { 0x01, 2, 0x0fff, false }, // ZPOS
+  { 0x03, 2, 0x0fff, false }, // MPOS
+  { 0x05, 2, 0x0fff, false }, // MANG
+  { 0x07, 2, 0x3fff, false }, // CONF
+  { 0x0b, 1, 0x0038, false }, // STATUS
+  { 0x0c, 2, 0x0fff, true  }, // RAW ANGLE
+  { 0x0e, 2, 0x0fff, true  }, // ANGLE
+  { 0x1a, 1, 0x00ff, false }, // AGC
+  { 0x1b, 2, 0x0fff, true  }  // MAGNITUDE
+};
+
+constexpr AS5600_RegisterInfo as5600_register(AS5600_Register reg)
+{
+  return as5600_registerMap[reg];
+}
+
+// address of the last byte of reg
+constexpr uint8_t as5600_registerEnd(AS5600_Register reg)
+{
+  return as5600_registerMap[reg].addr + as5600_registerMap[reg].width - 1;
+}
+
+#endif
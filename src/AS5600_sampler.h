@@ -0,0 +1,198 @@
+/****************************************************
+  AMS 5600 fixed-rate background sampler
+  File: AS5600_sampler.h
+
+  Description:  AS5600_Sampler reads the raw angle from
+  a hardware timer interrupt and pushes timestamped
+  samples into a lock-free single-producer/single-
+  consumer ring that loop() drains. Samples are taken
+  at the timer rate whatever loop() is busy with.
+
+  The interrupt uses the streamed raw angle read, a
+  single 2 byte read with no address phase, so the
+  transport has to be usable from an interrupt: the
+  bit-bang transports are, TwoWire is not (the AVR
+  Wire library waits on its own interrupt).
+  While sampling, use the driver only through the
+  sampler.
+
+  Usage:
+    AMS_5600_BITBANG<2, 3> ams5600;
+    AS5600_Sampler<AMS_5600_BITBANG<2, 3> > sampler(ams5600);
+
+    ISR(TIMER1_COMPA_vect) { sampler.tick(); }
+
+    void setup() { sampler.begin(); AS5600_Timer1::begin(1000); }
+    void loop()  { AS5600_TimedSample s; while (sampler.read(s)) ...; }
+***************************************************/
+
+#ifndef AS5600_SAMPLER_h
+#define AS5600_SAMPLER_h
+
+#include <Arduino.h>
+#include "AS5600_bus.h"
+
+// one raw angle read, timestamped when it was started
+struct AS5600_TimedSample
+{
+  unsigned long us;     // micros() at the start of the read
+  word angle;           // raw angle, valid if status is AS5600_OK
+  AS5600_Status status;
+};
+
+/*******************************************************
+  Single-producer/single-consumer ring. push() and
+  pop() may run concurrently, one of them in an
+  interrupt, without disabling interrupts: each index
+  is a single byte written by one side only, and the
+  slot is filled before the index that publishes it.
+  Capacity is a power of two up to 128 so the free
+  running byte indices wrap consistently.
+*******************************************************/
+template <class T, uint8_t Capacity>
+class AS5600_SampleRing
+{
+public:
+
+  static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+  static_assert((Capacity > 0) && (Capacity <= 128), "capacity must be 1 to 128");
+
+  AS5600_SampleRing() : _head(0), _tail(0) {}
+
+  // producer side, false if the ring is full
+  bool push(const T &item)
+  {
+    uint8_t head = _head;
+    if ((uint8_t)(head - _tail) == Capacity)
+      return false;
+    _items[head & (Capacity - 1)] = item;
+    __sync_synchronize();
+    _head = head + 1;
+    return true;
+  }
+
+  // consumer side, false if the ring is empty
+  bool pop(T &item)
+  {
+    uint8_t tail = _tail;
+    if (tail == _head)
+      return false;
+    __sync_synchronize();
+    item = _items[tail & (Capacity - 1)];
+    __sync_synchronize();
+    _tail = tail + 1;
+    return true;
+  }
+
+  uint8_t size() const { return _head - _tail; }
+  bool empty() const { return _head == _tail; }
+
+private:
+
+  T _items[Capacity];
+  volatile uint8_t _head; // written by the producer only
+  volatile uint8_t _tail; // written by the consumer only
+};
+
+template <class Driver, uint8_t Capacity = 32>
+class AS5600_Sampler
+{
+public:
+
+  AS5600_Sampler(Driver &driver) : _driver(driver), _dropped(0) {}
+
+  /*******************************************************
+    Method: begin
+    In: none
+    Out: 1 success, -1 the device did not acknowledge
+    Description: puts the driver in raw angle streaming
+    mode. Call before the timer is started.
+  *******************************************************/
+  int begin()
+  {
+    return _driver.beginAngleStream();
+  }
+
+  /*******************************************************
+    Method: tick
+    In: none
+    Out: none
+    Description: takes one sample, call from the timer
+    interrupt. A sample that finds the ring full is
+    dropped and counted.
+  *******************************************************/
+  void tick()
+  {
+    AS5600_TimedSample sample;
+    sample.us = micros();
+    sample.angle = 0;
+    sample.status = _driver.readRawAngle(sample.angle);
+    if (!_ring.push(sample))
+      _dropped++;
+  }
+
+  /*******************************************************
+    Method: read
+    In: sample to fill
+    Out: true if a sample was taken from the ring
+    Description: consumer side, call from loop().
+  *******************************************************/
+  bool read(AS5600_TimedSample &sample) { return _ring.pop(sample); }
+
+  uint8_t available() const { return _ring.size(); }
+
+  // samples lost because loop() did not drain the ring in time
+  unsigned int dropped()
+  {
+    noInterrupts();
+    unsigned int dropped = _dropped;
+    interrupts();
+    return dropped;
+  }
+
+private:
+
+  Driver &_driver;
+  AS5600_SampleRing<AS5600_TimedSample, Capacity> _ring;
+  volatile unsigned int _dropped;
+};
+
+#if defined(TCCR1A) && defined(OCIE1A)
+/*******************************************************
+  AVR Timer1 in CTC mode firing TIMER1_COMPA_vect at a
+  fixed rate. Takes Timer1 over, so it cannot be used
+  together with the Servo library or PWM on its pins.
+*******************************************************/
+struct AS5600_Timer1
+{
+  // false if hz cannot be reached with the Timer1 prescalers
+  static bool begin(unsigned long hz)
+  {
+    static const uint16_t prescalers[5] = { 1, 8, 64, 256, 1024 };
+    for (uint8_t i = 0; i < 5; i++) {
+      unsigned long ticks = F_CPU / prescalers[i] / hz;
+      if (ticks == 0)
+        return false;
+      if (ticks <= 65536UL) {
+        uint8_t oldSREG = SREG;
+        cli();
+        TCCR1A = 0;
+        TCCR1B = _BV(WGM12) | (i + 1); // CTC on OCR1A, CS12:0 selects the prescaler
+        TCNT1 = 0;
+        OCR1A = ticks - 1;
+        TIMSK1 |= _BV(OCIE1A);
+        SREG = oldSREG;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static void end()
+  {
+    TIMSK1 &= ~_BV(OCIE1A);
+  }
+};
+#endif
+
+#endif
@@ -16,16 +16,113 @@
 // datasheet: https://ams.com/documents/20143/36005/AS5600_DS000365_5-00.pdf
 
 #ifndef AMS_5600_SOFTWIRE_h
-#define AMS_5600_SOFTWIRE_h_h
+#define AMS_5600_SOFTWIRE_h
 
 #include <Arduino.h>
-#include <SoftWire.h>
+#include "AS5600_bus.h"
+#include "AS5600_registers.h"
+#include "AS5600_units.h"
 
-class AMS_5600_SOFTWIRE
+// contents of registers 0x00-0x08 as read in a single burst
+struct AS5600_ConfigSnapshot
+{
+  uint8_t zmco; // burn count
+  word zpos;    // start position
+  word mpos;    // end position
+  word mang;    // maximum angle
+  word conf;    // configuration
+} __attribute__((packed));
+
+// registers 0x0b-0x0f as read in a single burst: angles tagged with the magnet bits
+struct AS5600_Sample
+{
+  uint8_t status;       // STATUS register, 0 0 MD ML MH 0 0 0
+  bool magnetDetected;  // MD
+  bool magnetTooWeak;   // ML, AGC maximum overflow
+  bool magnetTooStrong; // MH, AGC minimum overflow
+  word rawAngle;
+  word angle;           // scaled angle
+};
+
+// registers 0x0b-0x1c as read in a single burst, all from the same instant
+struct AS5600_Telemetry : AS5600_Sample
+{
+  uint8_t agc;
+  word magnitude;
+};
+
+// CONF register fields (datasheet page 19)
+enum AS5600_PowerMode       { AS5600_PM_NOM = 0, AS5600_PM_LPM1, AS5600_PM_LPM2, AS5600_PM_LPM3 };
+enum AS5600_Hysteresis      { AS5600_HYST_OFF = 0, AS5600_HYST_1LSB, AS5600_HYST_2LSB, AS5600_HYST_3LSB };
+enum AS5600_OutputStage     { AS5600_OUTS_ANALOG = 0, AS5600_OUTS_ANALOG_REDUCED, AS5600_OUTS_PWM };
+enum AS5600_PwmFrequency    { AS5600_PWMF_115HZ = 0, AS5600_PWMF_230HZ, AS5600_PWMF_460HZ, AS5600_PWMF_920HZ };
+enum AS5600_SlowFilter      { AS5600_SF_16X = 0, AS5600_SF_8X, AS5600_SF_4X, AS5600_SF_2X };
+enum AS5600_FastFilter      { AS5600_FTH_SLOW_ONLY = 0, AS5600_FTH_6LSB, AS5600_FTH_7LSB, AS5600_FTH_9LSB,
+                              AS5600_FTH_18LSB, AS5600_FTH_21LSB, AS5600_FTH_24LSB, AS5600_FTH_10LSB };
+
+// completion callback of the asynchronous reads
+typedef void (*AS5600_ReadCallback)(AS5600_Status status, word value);
+
+// Bus is any transport described in AS5600_bus.h
+template <class Bus>
+class AMS_5600_Driver
 {
 public:
 
-  AMS_5600_SOFTWIRE(uint8_t, uint8_t);
+  typedef AS5600_ConfigSnapshot ConfigSnapshot;
+  typedef AS5600_Sample Sample;
+  typedef AS5600_Telemetry Telemetry;
+
+  // staged changes to 0x01-0x08, written by commit() in as few bursts as possible
+  class ConfigTransaction
+  {
+  public:
+
+    ConfigTransaction(AMS_5600_Driver &driver);
+
+    ConfigTransaction &setStartPosition(word startAngle);
+    ConfigTransaction &setEndPosition(word endAngle);
+    ConfigTransaction &setMaxAngle(word maxAngle);
+    ConfigTransaction &setConf(word conf);
+    ConfigTransaction &setPowerMode(AS5600_PowerMode mode);
+    ConfigTransaction &setHysteresis(AS5600_Hysteresis hyst);
+    ConfigTransaction &setOutputStage(AS5600_OutputStage stage);
+    ConfigTransaction &setPwmFrequency(AS5600_PwmFrequency freq);
+    ConfigTransaction &setSlowFilter(AS5600_SlowFilter filter);
+    ConfigTransaction &setFastFilter(AS5600_FastFilter threshold);
+    ConfigTransaction &setWatchdog(bool on);
+
+    bool dirty();
+    int commit(bool verify = false);
+
+  private:
+
+    // clean bytes between two dirty runs that are rewritten rather than
+    // paying for another START, address and register byte
+    static const uint8_t _mergeGap = 2;
+
+    AMS_5600_Driver &_driver;
+    bool _ready;      // shadow copy could be read
+    uint8_t _base[8]; // 0x01-0x08 as in the shadow copy
+    uint8_t _image[8];
+    uint8_t _dirty;   // bit i set when _image[i] differs from _base[i]
+
+    void stageWord(uint8_t reg, word value);
+    void stageConf(uint8_t shift, word mask, word value);
+  };
+
+  ConfigTransaction beginConfig();
+
+  // arguments are handed to the transport constructor
+  template <class... Args>
+  AMS_5600_Driver(Args&&... args)
+    : bus(static_cast<Args&&>(args)...), _pointer(-1), _streamReg(-1), _status(AS5600_OK),
+      _asyncReg(-1), _asyncStatus(AS5600_OK), _asyncValue(0), _asyncDone(0),
+      _shadowValid(false), _configWriteUs(0), _configWritten(false) {}
+
+  int begin();
+  int refreshShadow();
+
   int getAddress();
 
   word setMaxAngle(word newMaxAngle = -1);
@@ -51,14 +148,55 @@ public:
   int burnAngle();
   int burnMaxAngleAndConfig();
   void setOutPut(uint8_t mode);
-  
-  
+
+  // CONF fields, written only when they change
+  AS5600_Status setPowerMode(AS5600_PowerMode mode);
+  AS5600_Status setHysteresis(AS5600_Hysteresis hyst);
+  AS5600_Status setOutputStage(AS5600_OutputStage stage);
+  AS5600_Status setPwmFrequency(AS5600_PwmFrequency freq);
+  AS5600_Status setSlowFilter(AS5600_SlowFilter filter);
+  AS5600_Status setFastFilter(AS5600_FastFilter threshold);
+  AS5600_Status setWatchdog(bool on);
+  AS5600_PowerMode getPowerMode();
+  AS5600_Hysteresis getHysteresis();
+  AS5600_OutputStage getOutputStage();
+  AS5600_PwmFrequency getPwmFrequency();
+  AS5600_SlowFilter getSlowFilter();
+  AS5600_FastFilter getFastFilter();
+  bool getWatchdog();
+  int readConfigSnapshot(ConfigSnapshot &snapshot);
+  int writeConfigSnapshot(const ConfigSnapshot &snapshot);
+  int setOutputRange(word startAngle, word endAngle);
+
+  int beginAngleStream(int reg = _addr_raw_angle);
+  word readStreamed();
+  void endAngleStream();
+
+  AS5600_Status readRawAngle(word &angle);
+  AS5600_Status readScaledAngle(word &angle);
+  AS5600_Status readMagnitude(word &magnitude);
+  AS5600_Status readAgc(uint8_t &agc);
+  AS5600_Status readMagnetStatus(uint8_t &status);
+  AS5600_Status readSample(Sample &sample);
+  AS5600_Status readTelemetry(Telemetry &telemetry);
+  template <uint8_t N>
+  AS5600_Status readRegisters(const AS5600_Register (&regs)[N], word (&values)[N]);
+  AS5600_Status readRegisters(const AS5600_Register *regs, word *values, uint8_t count);
+  AS5600_Status lastStatus();
+  void setReadDeadline(unsigned long us);
+
+  // asynchronous reads, need a transport with startWriteRead/poll
+  AS5600_Status startRawAngleRead(AS5600_ReadCallback done = 0);
+  AS5600_Status startScaledAngleRead(AS5600_ReadCallback done = 0);
+  bool poll(uint8_t steps = 4);
+  bool readPending();
+  AS5600_Status asyncStatus();
+  word asyncValue();
+
+  Bus bus;
 
 private:
 
-  SoftWire sw;
-  static char swTxBuffer[16];
-  static char swRxBuffer[16];
   // i2c address
   static const uint8_t _ams5600_Address = 0x36;
   
@@ -88,10 +226,78 @@ private:
   static const uint8_t _addr_magnitude = 0x1b; // magnitude of internal CORDIC
                                                // 0x1c - lower byte
 
+  // clean bytes a planned read burst spans rather than paying for another
+  // address phase (START, address, register, repeated START, address)
+  static const uint8_t _readMergeGap = 3;
+  // registers one readRegisters call can take
+  static const uint8_t _maxReadRegisters = 32;
+
+  // CONF fields, shift and mask within the register word
+  static const uint8_t _conf_pm   = 0;  // 0x0003 power mode
+  static const uint8_t _conf_hyst = 2;  // 0x000c hysteresis
+  static const uint8_t _conf_outs = 4;  // 0x0030 output stage
+  static const uint8_t _conf_pwmf = 6;  // 0x00c0 PWM frequency
+  static const uint8_t _conf_sf   = 8;  // 0x0300 slow filter
+  static const uint8_t _conf_fth  = 10; // 0x1c00 fast filter threshold
+  static const uint8_t _conf_wd   = 13; // 0x2000 watchdog
+
+  // datasheet programming procedure: wait at least 1 ms after writing
+  // ZPOS/MPOS/MANG/CONF before the next step, in particular a BURN
+  static const unsigned int _burnSettleUs = 1000;
+
+  // last register the device address pointer is known to hold, -1 if unknown
+  int _pointer;
+  // register being streamed, -1 when streaming mode is off
+  int _streamReg;
+  // outcome of the last transaction
+  AS5600_Status _status;
+
+  // asynchronous read in flight, -1 when none
+  int _asyncReg;
+  uint8_t _asyncData[2];
+  AS5600_Status _asyncStatus;
+  word _asyncValue;
+  AS5600_ReadCallback _asyncDone;
+
+  // ZPOS, MPOS, MANG and CONF as last written or read, ZMCO is not kept up to date
+  ConfigSnapshot _shadow;
+  bool _shadowValid;
+  bool shadowReady();
+
+  // micros() of the last write to 0x01-0x08, for the wait before a burn
+  unsigned long _configWriteUs;
+  bool _configWritten;
+  void noteWrite(int adr, uint8_t len);
+  void waitBeforeBurn();
+  AS5600_Status updateConf(uint8_t shift, word mask, word value);
+  word confField(uint8_t shift, word mask);
+
+  AS5600_Status startTwoBytesRead(int addr_in, AS5600_ReadCallback done);
+
   int readOneByte(int in_adr);
-  word readTwoBytesSeparately(int addr_in);
+  AS5600_Status readOneByte(int in_adr, uint8_t &value);
+  word readTwoBytesBurst(int addr_in);
   word readTwoBytesTogether(int addr_in);
+  AS5600_Status readTwoBytesTogether(int addr_in, word &value);
+  AS5600_Status readBytes(int addr_in, uint8_t *data, uint8_t len);
+  static void decodeSample(const uint8_t *data, Sample &sample);
+  static bool startHoldsPointer(uint8_t addr_in);
+  static uint8_t burstStart(uint8_t first, uint8_t last);
   void writeOneByte(int adr_in, int dat_in);
+  AS5600_Status writeTwoBytes(int adr_in, word dat_in);
+  AS5600_Status writeBytes(int adr_in, const uint8_t *dat_in, uint8_t len);
 
 };
+
+// bit-banged driver on any two pins, the original interface of this library
+class AMS_5600_SOFTWIRE : public AMS_5600_Driver<AS5600_SoftWireBus<> >
+{
+public:
+
+  AMS_5600_SOFTWIRE(uint8_t sdaPin, uint8_t sclPin)
+    : AMS_5600_Driver<AS5600_SoftWireBus<> >(sdaPin, sclPin) {}
+};
+
+#include "AS5600_softwire_impl.h"
+
 #endif
\ No newline at end of file
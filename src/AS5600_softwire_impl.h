@@ -0,0 +1,1668 @@
+/****************************************************
+  AMS 5600 driver template implementation
+  File: AS5600_softwire_impl.h
+
+  Description:  Member definitions of AMS_5600_Driver.
+  Included at the end of AS5600_softwire.h, do not
+  include directly.
+*****************************************************/
+
+// datasheet: https://ams.com/documents/20143/36005/AS5600_DS000365_5-00.pdf
+
+#ifndef AMS_5600_SOFTWIRE_IMPL_h
+#define AMS_5600_SOFTWIRE_IMPL_h
+
+/*******************************************************
+  Method: setOutPut
+  In: 0 for digital PWM
+      1 for analog (full range 0-100% of GND to VDD)
+      2 for analog (reduced range 10-90%)
+  Out: none
+  Description: sets output mode in CONF register.
+  Nothing is written if the mode is already set.
+*******************************************************/
+template <class Bus>
+void AMS_5600_Driver<Bus>::setOutPut(uint8_t mode)
+{
+  if (mode == 0)
+    setOutputStage(AS5600_OUTS_PWM);
+  else if (mode == 2)
+    setOutputStage(AS5600_OUTS_ANALOG_REDUCED);
+  else
+    setOutputStage(AS5600_OUTS_ANALOG);
+}
+
+/*******************************************************
+  Method: setPowerMode, setHysteresis, setOutputStage,
+  setPwmFrequency, setSlowFilter, setFastFilter,
+  setWatchdog
+  In: new value of the CONF field
+  Out: status of the transaction, AS5600_OK if nothing
+  had to be written
+  Description: sets one field of the CONF register. The
+  new register value is computed from the shadow copy;
+  the bus is only used when the field changes, and then
+  only the byte holding it is written.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::setPowerMode(AS5600_PowerMode mode)
+{
+  return updateConf(_conf_pm, 0b11, mode);
+}
+
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::setHysteresis(AS5600_Hysteresis hyst)
+{
+  return updateConf(_conf_hyst, 0b11, hyst);
+}
+
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::setOutputStage(AS5600_OutputStage stage)
+{
+  return updateConf(_conf_outs, 0b11, stage);
+}
+
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::setPwmFrequency(AS5600_PwmFrequency freq)
+{
+  return updateConf(_conf_pwmf, 0b11, freq);
+}
+
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::setSlowFilter(AS5600_SlowFilter filter)
+{
+  return updateConf(_conf_sf, 0b11, filter);
+}
+
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::setFastFilter(AS5600_FastFilter threshold)
+{
+  return updateConf(_conf_fth, 0b111, threshold);
+}
+
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::setWatchdog(bool on)
+{
+  return updateConf(_conf_wd, 0b1, on ? 1 : 0);
+}
+
+/*******************************************************
+  Method: getPowerMode, getHysteresis, getOutputStage,
+  getPwmFrequency, getSlowFilter, getFastFilter,
+  getWatchdog
+  In: none
+  Out: value of the CONF field
+  Description: gets one field of the CONF register from
+  the shadow copy, see getConf.
+*******************************************************/
+template <class Bus>
+AS5600_PowerMode AMS_5600_Driver<Bus>::getPowerMode()
+{
+  return (AS5600_PowerMode)confField(_conf_pm, 0b11);
+}
+
+template <class Bus>
+AS5600_Hysteresis AMS_5600_Driver<Bus>::getHysteresis()
+{
+  return (AS5600_Hysteresis)confField(_conf_hyst, 0b11);
+}
+
+template <class Bus>
+AS5600_OutputStage AMS_5600_Driver<Bus>::getOutputStage()
+{
+  return (AS5600_OutputStage)confField(_conf_outs, 0b11);
+}
+
+template <class Bus>
+AS5600_PwmFrequency AMS_5600_Driver<Bus>::getPwmFrequency()
+{
+  return (AS5600_PwmFrequency)confField(_conf_pwmf, 0b11);
+}
+
+template <class Bus>
+AS5600_SlowFilter AMS_5600_Driver<Bus>::getSlowFilter()
+{
+  return (AS5600_SlowFilter)confField(_conf_sf, 0b11);
+}
+
+template <class Bus>
+AS5600_FastFilter AMS_5600_Driver<Bus>::getFastFilter()
+{
+  return (AS5600_FastFilter)confField(_conf_fth, 0b111);
+}
+
+template <class Bus>
+bool AMS_5600_Driver<Bus>::getWatchdog()
+{
+  return confField(_conf_wd, 0b1) != 0;
+}
+
+/****************************************************
+  Method: AMS_5600
+  In: none
+  Out: i2c address of AMS 5600
+  Description: returns i2c address of AMS 5600
+****************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::getAddress()
+{
+  return _ams5600_Address;
+}
+
+/*******************************************************
+  Method: setMaxAngle
+  In: new maximum angle to set OR none
+  Out: value of max angle register
+  Description: sets a value in maximum angle register.
+  If no value is provided, method will read position of
+  magnet.  Setting this register zeros out max position
+  register. Both bytes go out in one transaction, MPOS
+  and MANG are read back together for the shadow copy.
+  Returns 0 if the write or the read back failed.
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::setMaxAngle(word newMaxAngle)
+{
+  word _maxAngle;
+  if (newMaxAngle == (word)-1)
+    _maxAngle = getRawAngle();
+  else
+    _maxAngle = newMaxAngle;
+
+  uint8_t data[4];
+  if ((writeTwoBytes(_addr_mang, _maxAngle) != AS5600_OK) ||
+      (readBytes(_addr_mpos, data, sizeof(data)) != AS5600_OK)) {
+    _shadowValid = false;
+    return 0;
+  }
+  _shadow.mpos = (data[0] << 8) | data[1];
+  _shadow.mang = (data[2] << 8) | data[3];
+  return _shadow.mang;
+}
+
+/*******************************************************
+  Method: getMaxAngle
+  In: none
+  Out: value of max angle register
+  Description: gets value of maximum angle register.
+  Served from the shadow copy, which is filled from
+  the device on first use. 0 if it cannot be read.
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::getMaxAngle()
+{
+  if (!shadowReady())
+    return 0;
+  return _shadow.mang;
+}
+
+/*******************************************************
+  Method: setStartPosition
+  In: new start angle position
+  Out: value of start position register
+  Description: sets a value in start position register.
+  If no value is provided, method will read position of
+  magnet.  Both bytes go out in one transaction.
+  Returns 0 if the write or the read back failed.
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::setStartPosition(word startAngle)
+{
+  word _rawStartAngle;
+  if (startAngle == (word)-1)
+    _rawStartAngle = getRawAngle();
+  else
+    _rawStartAngle = startAngle;
+
+  if (writeTwoBytes(_addr_zpos, _rawStartAngle) != AS5600_OK) {
+    _shadowValid = false;
+    return 0;
+  }
+  word _zPosition = readTwoBytesBurst(_addr_zpos);
+  if (_status == AS5600_OK)
+    _shadow.zpos = _zPosition;
+  else
+    _shadowValid = false;
+
+  return (_zPosition);
+}
+
+/*******************************************************
+  Method: getStartPosition
+  In: none
+  Out: value of start position register
+  Description: gets value of start position register.
+  Served from the shadow copy, which is filled from
+  the device on first use. 0 if it cannot be read.
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::getStartPosition()
+{
+  if (!shadowReady())
+    return 0;
+  return _shadow.zpos;
+}
+
+/*******************************************************
+  Method: setEndPosition
+  In: new end angle position
+  Out: value of end position register
+  Description: sets a value in end position register.
+  If no value is provided, method will read position of
+  magnet.  Both bytes go out in one transaction.
+  Returns 0 if the write or the read back failed.
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::setEndPosition(word endAngle)
+{
+  word _rawEndAngle;
+  if (endAngle == (word)-1)
+    _rawEndAngle = getRawAngle();
+  else
+    _rawEndAngle = endAngle;
+
+  if (writeTwoBytes(_addr_mpos, _rawEndAngle) != AS5600_OK) {
+    _shadowValid = false;
+    return 0;
+  }
+  word _mPosition = readTwoBytesBurst(_addr_mpos);
+  if (_status == AS5600_OK)
+    _shadow.mpos = _mPosition;
+  else
+    _shadowValid = false;
+
+  return (_mPosition);
+}
+
+/*******************************************************
+  Method: getEndPosition
+  In: none
+  Out: value of end position register
+  Description: gets value of end position register.
+  Served from the shadow copy, which is filled from
+  the device on first use. 0 if it cannot be read.
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::getEndPosition()
+{
+  if (!shadowReady())
+    return 0;
+  return _shadow.mpos;
+}
+
+/*******************************************************
+  Method: getRawAngle
+  In: none
+  Out: value of raw angle register
+  Description: gets raw value of magnet position.
+  start, end, and max angle settings do not apply
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::getRawAngle()
+{
+  return readTwoBytesTogether(_addr_raw_angle);
+}
+
+/*******************************************************
+  Method: getScaledAngle
+  In: none
+  Out: value of scaled angle register
+  Description: gets scaled value of magnet position.
+  start, end, or max angle settings are used to 
+  determine value
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::getScaledAngle()
+{
+  return readTwoBytesTogether(_addr_angle);
+}
+
+/*******************************************************
+  Method: detectMagnet
+  In: none
+  Out: 1 if magnet is detected, 0 if not or if the
+       status register could not be read
+  Description: reads status register and examines the 
+  MD bit.
+*******************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::detectMagnet()
+{
+  // Status bits: 0 0 MD ML MH 0 0 0 
+  // MD high = magnet detected  
+  uint8_t magStatus;
+  if (readOneByte(_addr_status, magStatus) != AS5600_OK)
+    return 0;
+  return (magStatus & 0x20) ? 1 : 0;
+}
+
+/*******************************************************
+  Method: getMagnetStrength
+  In: none
+  Out: 0 if magnet not detected, or the status register
+         could not be read
+       1 if magnet is too weak
+       2 if magnet is just right
+       3 if magnet is too strong
+  Description: reads status register and examines the 
+  MH,ML,MD bits.
+*******************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::getMagnetStrength()
+{
+  int retVal = 0; // no magnet
+  // Status bits: 0 0 MD ML MH 0 0 0 
+  // MD high = magnet detected  
+  // ML high = AGC maximum overflow, magnet too weak
+  // MH high = AGC minimum overflow, magnet too strong
+  uint8_t magStatus;
+  if (readOneByte(_addr_status, magStatus) != AS5600_OK)
+    return retVal;
+  if (magStatus & 0x20) {
+    retVal = 2;   // magnet detected
+    if (magStatus & 0x10)
+      retVal = 1; // too weak
+    else if (magStatus & 0x08)
+      retVal = 3; // too strong
+  }
+  
+  return retVal;
+}
+
+/*******************************************************
+  Method: get Agc
+  In: none
+  Out: value of AGC register
+  Description: gets value of AGC register.
+*******************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::getAgc()
+{
+  return readOneByte(_addr_agc);
+}
+
+/*******************************************************
+  Method: getMagnitude
+  In: none
+  Out: value of magnitude register
+  Description: gets value of magnitude register.
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::getMagnitude()
+{
+  return readTwoBytesTogether(_addr_magnitude);
+}
+
+/*******************************************************
+  Method: getConf
+  In: none
+  Out: value of CONF register 
+  Description: gets value of CONF register.
+  Served from the shadow copy, which is filled from
+  the device on first use. 0 if it cannot be read.
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::getConf()
+{
+  if (!shadowReady())
+    return 0;
+  return _shadow.conf;
+}
+
+/*******************************************************
+  Method: setConf
+  In: value of CONF register
+  Out: none
+  Description: sets value of CONF register, both bytes
+  in one transaction.
+*******************************************************/
+template <class Bus>
+void AMS_5600_Driver<Bus>::setConf(word _conf)
+{
+  if (writeTwoBytes(_addr_conf, _conf) == AS5600_OK)
+    _shadow.conf = _conf;
+  else
+    _shadowValid = false;
+}
+
+/*******************************************************
+  Method: getBurnCount
+  In: none
+  Out: value of zmco register
+  Description: determines how many times chip has been
+  permanently written to. 
+*******************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::getBurnCount()
+{
+  return readOneByte(_addr_zmco);
+}
+
+/*******************************************************
+  Method: burnAngle
+  In: none
+  Out: 1 success
+      -1 no magnet
+      -2 burn limit exceeded
+      -3 start and end positions not set (useless burn)
+      -4 configuration or status could not be read
+  Description: burns start and end positions to chip,
+  at least 1 ms after the last configuration write.
+  THIS CAN ONLY BE DONE 3 TIMES
+*******************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::burnAngle()
+{
+  ConfigSnapshot config;
+  if (readConfigSnapshot(config) != 1)
+    return -4;
+  uint8_t magStatus;
+  if (readMagnetStatus(magStatus) != AS5600_OK)
+    return -4;
+
+  int retVal = 1;
+  if (magStatus & 0x20) {
+    if (config.zmco < 3) {
+      if ((config.zpos == 0) && (config.mpos == 0))
+        retVal = -3;
+      else {
+        waitBeforeBurn();
+        writeOneByte(_addr_burn, 0x80);
+      }
+    }
+    else
+      retVal = -2;
+  } else
+    retVal = -1;
+
+  return retVal;
+}
+
+/*******************************************************
+  Method: burnMaxAngleAndConfig
+  In: none
+  Out: 1 success
+      -1 burn limit exceeded
+      -2 max angle is to small, must be at or above 18 degrees
+      -3 configuration could not be read
+  Description: burns max angle and config data to chip,
+  at least 1 ms after the last configuration write.
+  THIS CAN ONLY BE DONE 1 TIME
+*******************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::burnMaxAngleAndConfig()
+{
+  ConfigSnapshot config;
+  if (readConfigSnapshot(config) != 1)
+    return -3;
+
+  int retVal = 1;
+  if (config.zmco == 0) {
+    if (as5600_toCentidegrees(config.mang & 0x0fff) < 1800)
+      retVal = -2;
+    else {
+      waitBeforeBurn();
+      writeOneByte(_addr_burn, 0x40);
+    }
+  }
+  else
+    retVal = -1;
+
+  return retVal;
+}
+
+/*******************************************************
+  Method: readConfigSnapshot
+  In: snapshot to fill
+  Out: 1 success
+      -1 short read, snapshot left untouched
+  Description: reads ZMCO, ZPOS, MPOS, MANG and CONF
+  (0x00-0x08) in one burst. The pointer auto-increments
+  over these registers, so one address write and one
+  9 byte read replace the 9 transactions of the single
+  getters. Also refreshes the shadow copy.
+*******************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::readConfigSnapshot(ConfigSnapshot &snapshot)
+{
+  uint8_t data[9];
+  if (readBytes(_addr_zmco, data, sizeof(data)) != AS5600_OK)
+    return -1;
+
+  snapshot.zmco = data[0];
+  snapshot.zpos = (data[1] << 8) | data[2];
+  snapshot.mpos = (data[3] << 8) | data[4];
+  snapshot.mang = (data[5] << 8) | data[6];
+  snapshot.conf = (data[7] << 8) | data[8];
+  _shadow = snapshot;
+  _shadowValid = true;
+  return 1;
+}
+
+/*******************************************************
+  Method: writeConfigSnapshot
+  In: snapshot to write
+  Out: 1 success
+      -1 the device did not acknowledge
+  Description: writes ZPOS, MPOS, MANG and CONF
+  (0x01-0x08) in one burst. ZMCO is read only and is
+  ignored. Reads see the new values at once; a burn
+  must wait 1 ms, which burnAngle() and
+  burnMaxAngleAndConfig() take care of.
+*******************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::writeConfigSnapshot(const ConfigSnapshot &snapshot)
+{
+  uint8_t data[8] = {
+    highByte(snapshot.zpos), lowByte(snapshot.zpos),
+    highByte(snapshot.mpos), lowByte(snapshot.mpos),
+    highByte(snapshot.mang), lowByte(snapshot.mang),
+    highByte(snapshot.conf), lowByte(snapshot.conf)
+  };
+  if (writeBytes(_addr_zpos, data, sizeof(data)) != AS5600_OK) {
+    _shadowValid = false;
+    return -1;
+  }
+  _shadow.zpos = snapshot.zpos;
+  _shadow.mpos = snapshot.mpos;
+  _shadow.mang = snapshot.mang;
+  _shadow.conf = snapshot.conf;
+  return 1;
+}
+
+/*******************************************************
+  Method: setOutputRange
+  In: new start and end positions
+  Out: 1 success
+      -1 the device did not acknowledge
+  Description: moves the output window by writing ZPOS
+  and MPOS (0x01-0x04) in one burst, cheap enough to
+  re-range at run time.
+*******************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::setOutputRange(word startAngle, word endAngle)
+{
+  uint8_t data[4] = {
+    highByte(startAngle), lowByte(startAngle),
+    highByte(endAngle), lowByte(endAngle)
+  };
+  if (writeBytes(_addr_zpos, data, sizeof(data)) != AS5600_OK) {
+    _shadowValid = false;
+    return -1;
+  }
+  _shadow.zpos = startAngle;
+  _shadow.mpos = endAngle;
+  return 1;
+}
+
+/*******************************************************
+  Method: beginConfig
+  In: none
+  Out: empty configuration transaction
+  Description: starts staging changes to ZPOS, MPOS,
+  MANG and CONF. Nothing reaches the device until
+  commit() is called:
+
+    ams5600.beginConfig()
+      .setStartPosition(100)
+      .setEndPosition(2000)
+      .setOutputStage(AS5600_OUTS_PWM)
+      .commit(true);
+*******************************************************/
+template <class Bus>
+typename AMS_5600_Driver<Bus>::ConfigTransaction AMS_5600_Driver<Bus>::beginConfig()
+{
+  return ConfigTransaction(*this);
+}
+
+/*******************************************************
+  Method: ConfigTransaction
+  In: driver to configure
+  Out: none
+  Description: takes the current register values from
+  the shadow copy of the driver, reading it first if
+  needed.
+*******************************************************/
+template <class Bus>
+AMS_5600_Driver<Bus>::ConfigTransaction::ConfigTransaction(AMS_5600_Driver &driver)
+  : _driver(driver), _dirty(0)
+{
+  _ready = _driver.shadowReady();
+  const ConfigSnapshot &shadow = _driver._shadow;
+  word values[4] = { shadow.zpos, shadow.mpos, shadow.mang, shadow.conf };
+  for (uint8_t i = 0; i < 4; i++) {
+    _base[2 * i]     = highByte(values[i]);
+    _base[2 * i + 1] = lowByte(values[i]);
+  }
+  for (uint8_t i = 0; i < 8; i++)
+    _image[i] = _base[i];
+}
+
+/*******************************************************
+  Method: setStartPosition, setEndPosition, setMaxAngle,
+  setConf
+  In: new register value
+  Out: the transaction, for chaining
+  Description: stages a two byte register. Bytes equal
+  to the current device value are not marked dirty.
+*******************************************************/
+template <class Bus>
+typename AMS_5600_Driver<Bus>::ConfigTransaction &
+AMS_5600_Driver<Bus>::ConfigTransaction::setStartPosition(word startAngle)
+{
+  stageWord(_addr_zpos, startAngle);
+  return *this;
+}
+
+template <class Bus>
+typename AMS_5600_Driver<Bus>::ConfigTransaction &
+AMS_5600_Driver<Bus>::ConfigTransaction::setEndPosition(word endAngle)
+{
+  stageWord(_addr_mpos, endAngle);
+  return *this;
+}
+
+template <class Bus>
+typename AMS_5600_Driver<Bus>::ConfigTransaction &
+AMS_5600_Driver<Bus>::ConfigTransaction::setMaxAngle(word maxAngle)
+{
+  stageWord(_addr_mang, maxAngle);
+  return *this;
+}
+
+template <class Bus>
+typename AMS_5600_Driver<Bus>::ConfigTransaction &
+AMS_5600_Driver<Bus>::ConfigTransaction::setConf(word conf)
+{
+  stageWord(_addr_conf, conf);
+  return *this;
+}
+
+/*******************************************************
+  Method: setPowerMode, setHysteresis, setOutputStage,
+  setPwmFrequency, setSlowFilter, setFastFilter,
+  setWatchdog
+  In: new value of the CONF field
+  Out: the transaction, for chaining
+  Description: stages one field of the CONF register on
+  top of the CONF value staged so far.
+*******************************************************/
+template <class Bus>
+typename AMS_5600_Driver<Bus>::ConfigTransaction &
+AMS_5600_Driver<Bus>::ConfigTransaction::setPowerMode(AS5600_PowerMode mode)
+{
+  stageConf(_conf_pm, 0b11, mode);
+  return *this;
+}
+
+template <class Bus>
+typename AMS_5600_Driver<Bus>::ConfigTransaction &
+AMS_5600_Driver<Bus>::ConfigTransaction::setHysteresis(AS5600_Hysteresis hyst)
+{
+  stageConf(_conf_hyst, 0b11, hyst);
+  return *this;
+}
+
+template <class Bus>
+typename AMS_5600_Driver<Bus>::ConfigTransaction &
+AMS_5600_Driver<Bus>::ConfigTransaction::setOutputStage(AS5600_OutputStage stage)
+{
+  stageConf(_conf_outs, 0b11, stage);
+  return *this;
+}
+
+template <class Bus>
+typename AMS_5600_Driver<Bus>::ConfigTransaction &
+AMS_5600_Driver<Bus>::ConfigTransaction::setPwmFrequency(AS5600_PwmFrequency freq)
+{
+  stageConf(_conf_pwmf, 0b11, freq);
+  return *this;
+}
+
+template <class Bus>
+typename AMS_5600_Driver<Bus>::ConfigTransaction &
+AMS_5600_Driver<Bus>::ConfigTransaction::setSlowFilter(AS5600_SlowFilter filter)
+{
+  stageConf(_conf_sf, 0b11, filter);
+  return *this;
+}
+
+template <class Bus>
+typename AMS_5600_Driver<Bus>::ConfigTransaction &
+AMS_5600_Driver<Bus>::ConfigTransaction::setFastFilter(AS5600_FastFilter threshold)
+{
+  stageConf(_conf_fth, 0b111, threshold);
+  return *this;
+}
+
+template <class Bus>
+typename AMS_5600_Driver<Bus>::ConfigTransaction &
+AMS_5600_Driver<Bus>::ConfigTransaction::setWatchdog(bool on)
+{
+  stageConf(_conf_wd, 0b1, on ? 1 : 0);
+  return *this;
+}
+
+/*******************************************************
+  Method: dirty
+  In: none
+  Out: true if commit() has something to write
+*******************************************************/
+template <class Bus>
+bool AMS_5600_Driver<Bus>::ConfigTransaction::dirty()
+{
+  return _dirty != 0;
+}
+
+/*******************************************************
+  Method: commit
+  In: true to read the registers back afterwards
+  Out: 1 success, also when nothing was staged
+      -1 the device did not acknowledge a write
+      -2 read back differs from what was written,
+         or could not be read
+      -3 current configuration could not be read
+  Description: writes the dirty bytes of 0x01-0x08.
+  Each run of dirty bytes becomes one burst; runs
+  separated by up to _mergeGap clean bytes share a
+  burst, the clean bytes being rewritten with their
+  current value. With verify, one 8 byte burst read
+  checks every byte that was written. The shadow copy
+  of the driver follows the device.
+*******************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::ConfigTransaction::commit(bool verify)
+{
+  if (!_ready)
+    return -3;
+  if (_dirty == 0)
+    return 1;
+
+  uint8_t written = 0;
+  uint8_t i = 0;
+  while (i < 8) {
+    if (!(_dirty & (1 << i))) {
+      i++;
+      continue;
+    }
+    uint8_t last = i;
+    for (uint8_t j = i + 1; (j < 8) && (j - last - 1 <= _mergeGap); j++)
+      if (_dirty & (1 << j))
+        last = j;
+    if (_driver.writeBytes(_addr_zpos + i, _image + i, last - i + 1) != AS5600_OK) {
+      _driver._shadowValid = false;
+      return -1;
+    }
+    for (uint8_t j = i; j <= last; j++)
+      written |= 1 << j;
+    i = last + 1;
+  }
+
+  ConfigSnapshot &shadow = _driver._shadow;
+  shadow.zpos = (_image[0] << 8) | _image[1];
+  shadow.mpos = (_image[2] << 8) | _image[3];
+  shadow.mang = (_image[4] << 8) | _image[5];
+  shadow.conf = (_image[6] << 8) | _image[7];
+  for (uint8_t j = 0; j < 8; j++)
+    _base[j] = _image[j];
+  _dirty = 0;
+
+  if (!verify)
+    return 1;
+
+  uint8_t data[8];
+  if (_driver.readBytes(_addr_zpos, data, sizeof(data)) != AS5600_OK) {
+    _driver._shadowValid = false;
+    return -2;
+  }
+  shadow.zpos = (data[0] << 8) | data[1];
+  shadow.mpos = (data[2] << 8) | data[3];
+  shadow.mang = (data[4] << 8) | data[5];
+  shadow.conf = (data[6] << 8) | data[7];
+  for (uint8_t j = 0; j < 8; j++)
+    if ((written & (1 << j)) && (data[j] != _image[j]))
+      return -2;
+  return 1;
+}
+
+/*******************************************************
+  Method: stageWord
+  In: register address and value
+  Out: none
+  Description: puts a two byte register into the image
+  and updates the dirty bits of both bytes.
+*******************************************************/
+template <class Bus>
+void AMS_5600_Driver<Bus>::ConfigTransaction::stageWord(uint8_t reg, word value)
+{
+  uint8_t i = reg - _addr_zpos;
+  _image[i]     = highByte(value);
+  _image[i + 1] = lowByte(value);
+  for (uint8_t j = i; j <= i + 1; j++) {
+    if (_image[j] != _base[j])
+      _dirty |= 1 << j;
+    else
+      _dirty &= ~(1 << j);
+  }
+}
+
+/*******************************************************
+  Method: stageConf
+  In: field position, field mask and new field value
+  Out: none
+  Description: stages a CONF field, see updateConf.
+*******************************************************/
+template <class Bus>
+void AMS_5600_Driver<Bus>::ConfigTransaction::stageConf(uint8_t shift, word mask, word value)
+{
+  uint8_t i = _addr_conf - _addr_zpos;
+  word conf = (_image[i] << 8) | _image[i + 1];
+  conf = (conf & ~(mask << shift)) | ((value & mask) << shift);
+  stageWord(_addr_conf, conf);
+}
+
+/*******************************************************
+  Method: begin
+  In: none
+  Out: 1 success
+      -1 configuration could not be read
+  Description: fills the shadow copy of ZPOS, MPOS,
+  MANG and CONF with one burst read. Call once from
+  setup(); the getters then answer from RAM.
+*******************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::begin()
+{
+  return refreshShadow();
+}
+
+/*******************************************************
+  Method: refreshShadow
+  In: none
+  Out: 1 success
+      -1 configuration could not be read
+  Description: reloads the shadow copy from the device,
+  e.g. when it may have been power cycled or reset and
+  lost its volatile settings.
+*******************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::refreshShadow()
+{
+  ConfigSnapshot config;
+  return readConfigSnapshot(config);
+}
+
+/*******************************************************
+  Method: beginAngleStream
+  In: register to stream (raw angle, angle or magnitude)
+  Out: 1 success
+      -1 register does not suppress pointer increment,
+         or the device did not acknowledge
+  Description: loads the device address pointer with
+  the given register and enables streaming mode. While
+  the pointer is still valid, reads of that register
+  skip the address write phase (datasheet page 13).
+*******************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::beginAngleStream(int reg)
+{
+  if ((reg != _addr_raw_angle) && (reg != _addr_angle) && (reg != _addr_magnitude))
+    return -1;
+
+  uint8_t reg_addr = reg;
+  _status = bus.write(_ams5600_Address, &reg_addr, 1);
+  if (_status != AS5600_OK)
+    return -1;
+  _pointer = reg;
+  _streamReg = reg;
+
+  return 1;
+}
+
+/*******************************************************
+  Method: readStreamed
+  In: none
+  Out: value of the streamed register
+  Description: reads the register selected with
+  beginAngleStream (raw angle if none was). Only the
+  read phase goes on the wire unless another access
+  moved the device pointer, in which case it is
+  reloaded first.
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::readStreamed()
+{
+  if (_streamReg == -1)
+    beginAngleStream();
+  return readTwoBytesTogether(_streamReg);
+}
+
+/*******************************************************
+  Method: endAngleStream
+  In: none
+  Out: none
+  Description: leaves streaming mode, every read sends
+  its address write phase again. Call it as well if the
+  device may have been reset behind our back.
+*******************************************************/
+template <class Bus>
+void AMS_5600_Driver<Bus>::endAngleStream()
+{
+  _streamReg = -1;
+  _pointer = -1;
+}
+
+/*******************************************************
+  Method: readRawAngle
+  In: variable to store the raw angle in
+  Out: status of the transaction
+  Description: like getRawAngle, but reports whether
+  the read succeeded. angle is untouched on failure.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::readRawAngle(word &angle)
+{
+  return readTwoBytesTogether(_addr_raw_angle, angle);
+}
+
+/*******************************************************
+  Method: readScaledAngle
+  In: variable to store the scaled angle in
+  Out: status of the transaction
+  Description: like getScaledAngle, with status.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::readScaledAngle(word &angle)
+{
+  return readTwoBytesTogether(_addr_angle, angle);
+}
+
+/*******************************************************
+  Method: readMagnitude
+  In: variable to store the magnitude in
+  Out: status of the transaction
+  Description: like getMagnitude, with status.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::readMagnitude(word &magnitude)
+{
+  return readTwoBytesTogether(_addr_magnitude, magnitude);
+}
+
+/*******************************************************
+  Method: readAgc
+  In: variable to store the AGC value in
+  Out: status of the transaction
+  Description: like getAgc, with status.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::readAgc(uint8_t &agc)
+{
+  return readOneByte(_addr_agc, agc);
+}
+
+/*******************************************************
+  Method: readMagnetStatus
+  In: variable to store the STATUS register in
+  Out: status of the transaction
+  Description: reads the MD, ML and MH bits
+  (0 0 MD ML MH 0 0 0).
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::readMagnetStatus(uint8_t &status)
+{
+  return readOneByte(_addr_status, status);
+}
+
+/*******************************************************
+  Method: readSample
+  In: sample to fill
+  Out: status of the transaction
+  Description: reads STATUS, RAW ANGLE and ANGLE
+  (0x0b-0x0f) in one 5 byte burst, so each angle comes
+  with the magnet bits of the same instant and no
+  separate detectMagnet() is needed. The sample is left
+  untouched on failure.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::readSample(Sample &sample)
+{
+  uint8_t data[_addr_angle + 2 - _addr_status];
+  if (readBytes(_addr_status, data, sizeof(data)) != AS5600_OK)
+    return _status;
+
+  decodeSample(data, sample);
+  return _status;
+}
+
+/*******************************************************
+  Method: readTelemetry
+  In: frame to fill
+  Out: status of the transaction
+  Description: reads STATUS, RAW ANGLE, ANGLE, AGC and
+  MAGNITUDE (0x0b-0x1c) in one burst with a single
+  address phase, so every field comes from the same
+  instant. Starting the read at 0x0b keeps the pointer
+  incrementing through the angle registers. The frame
+  is left untouched on failure.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::readTelemetry(Telemetry &telemetry)
+{
+  uint8_t data[_addr_magnitude + 2 - _addr_status];
+  if (readBytes(_addr_status, data, sizeof(data)) != AS5600_OK)
+    return _status;
+
+  decodeSample(data, telemetry);
+  telemetry.agc       = data[_addr_agc - _addr_status];
+  telemetry.magnitude = (data[_addr_magnitude - _addr_status] << 8) | data[_addr_magnitude + 1 - _addr_status];
+  return _status;
+}
+
+/*******************************************************
+  Method: readRegisters
+  In: registers to read, one word per register
+  Out: status of the first failed burst, AS5600_OK if
+  all were read
+  Description: reads any set of registers, e.g.
+
+    word values[2];
+    ams5600.readRegisters({ AS5600_STATUS, AS5600_AGC }, values);
+
+  see the pointer/count overload for how the bursts are
+  planned.
+*******************************************************/
+template <class Bus>
+template <uint8_t N>
+AS5600_Status AMS_5600_Driver<Bus>::readRegisters(const AS5600_Register (&regs)[N], word (&values)[N])
+{
+  static_assert(N <= _maxReadRegisters, "at most 32 registers per readRegisters call");
+  return readRegisters(regs, values, N);
+}
+
+/*******************************************************
+  Method: readRegisters
+  In: registers to read, one word per register, count
+  (at most 32)
+  Out: status of the first failed burst, AS5600_OK if
+  all were read, AS5600_NACK without touching the bus
+  if count is above 32
+  Description: plans the reads from the register map.
+  Requested registers are taken in address order and
+  merged into one burst while the bytes skipped in
+  between stay within _readMergeGap and the burst fits
+  AS5600_BURST_MAX. A burst may not start on a register
+  that holds the pointer unless it reads that register
+  alone, so such bursts start one byte earlier. A burst
+  of just RAW ANGLE, ANGLE or MAGNITUDE is read like
+  readTwoBytesTogether and honours streaming mode.
+  values[i] receives regs[i] with unimplemented bits
+  cleared, and is left untouched if its burst failed.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::readRegisters(const AS5600_Register *regs, word *values, uint8_t count)
+{
+  // one bit per register in the pending/members masks
+  if (count > _maxReadRegisters) {
+    _status = AS5600_NACK;
+    return _status;
+  }
+  AS5600_Status result = AS5600_OK;
+  uint32_t pending = (count == _maxReadRegisters) ? 0xffffffffUL : ((1UL << count) - 1);
+
+  while (pending) {
+    // grow a burst from the lowest pending address upwards
+    uint32_t members = 0;
+    uint8_t start = 0;
+    uint8_t end = 0;
+    for (;;) {
+      int next = -1;
+      for (uint8_t i = 0; i < count; i++)
+        if ((pending & ~members & (1UL << i)) &&
+            ((next == -1) || (as5600_register(regs[i]).addr < as5600_register(regs[next]).addr)))
+          next = i;
+      if (next == -1)
+        break;
+
+      AS5600_RegisterInfo info = as5600_register(regs[next]);
+      uint8_t last = as5600_registerEnd(regs[next]);
+      if (members == 0) {
+        start = info.addr;
+        end = last;
+      } else {
+        uint8_t newEnd = last > end ? last : end;
+        uint8_t first = burstStart(start, newEnd);
+        if ((info.addr > end + 1 + _readMergeGap) || (newEnd - first + 1 > AS5600_BURST_MAX))
+          break;
+        end = newEnd;
+      }
+      members |= 1UL << next;
+    }
+
+    uint8_t first = burstStart(start, end);
+
+    AS5600_Status status;
+    uint8_t data[AS5600_BURST_MAX];
+    if ((first == start) && startHoldsPointer(start)) {
+      word value = 0;
+      status = readTwoBytesTogether(start, value);
+      data[0] = highByte(value);
+      data[1] = lowByte(value);
+    } else {
+      status = readBytes(first, data, end - first + 1);
+    }
+
+    if (status == AS5600_OK) {
+      for (uint8_t i = 0; i < count; i++) {
+        if (!(members & (1UL << i)))
+          continue;
+        AS5600_RegisterInfo info = as5600_register(regs[i]);
+        const uint8_t *bytes = data + (info.addr - first);
+        word value = (info.width == 2) ? ((bytes[0] << 8) | bytes[1]) : bytes[0];
+        values[i] = value & info.mask;
+      }
+    } else if (result == AS5600_OK) {
+      result = status;
+    }
+    pending &= ~members;
+  }
+  return result;
+}
+
+/*******************************************************
+  Method: lastStatus
+  In: none
+  Out: status of the last bus transaction
+  Description: lets callers of the plain getters, which
+  can only return a value, find out whether it is real.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::lastStatus()
+{
+  return _status;
+}
+
+/*******************************************************
+  Method: setReadDeadline
+  In: deadline in microseconds
+  Out: none
+  Description: bounds the time any single transaction
+  may wait on the bus. A call then takes at most its
+  fixed transfer time plus this deadline per
+  transaction, and reports AS5600_TIMEOUT otherwise.
+*******************************************************/
+template <class Bus>
+void AMS_5600_Driver<Bus>::setReadDeadline(unsigned long us)
+{
+  bus.setDeadline(us);
+}
+
+/*******************************************************
+  Method: startRawAngleRead
+  In: optional completion callback
+  Out: AS5600_OK if started
+       AS5600_BUSY if a transfer is already running
+  Description: starts reading the raw angle in the
+  background. Drive it with poll() from the main loop;
+  the callback, if any, runs from the poll() call that
+  completes the read. Streaming mode is honoured, so a
+  streamed register only costs the read phase.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::startRawAngleRead(AS5600_ReadCallback done)
+{
+  return startTwoBytesRead(_addr_raw_angle, done);
+}
+
+/*******************************************************
+  Method: startScaledAngleRead
+  In: optional completion callback
+  Out: AS5600_OK if started
+       AS5600_BUSY if a transfer is already running
+  Description: as startRawAngleRead, for the scaled
+  angle.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::startScaledAngleRead(AS5600_ReadCallback done)
+{
+  return startTwoBytesRead(_addr_angle, done);
+}
+
+/*******************************************************
+  Method: poll
+  In: number of steps (half SCL periods) to run
+  Out: true on the call that completes the read
+  Description: advances the asynchronous read. A two
+  byte read takes about 130 steps, 70 when streamed, so
+  the default of 4 costs a few microseconds per call.
+  Results are available from asyncStatus/asyncValue.
+*******************************************************/
+template <class Bus>
+bool AMS_5600_Driver<Bus>::poll(uint8_t steps)
+{
+  if (_asyncReg == -1)
+    return false;
+
+  AS5600_Status status = bus.poll(steps);
+  if (status == AS5600_BUSY)
+    return false;
+
+  _asyncStatus = status;
+  _status = status;
+  if (status == AS5600_OK) {
+    _asyncValue = (_asyncData[0] << 8) | _asyncData[1];
+    _pointer = _asyncReg;
+  }
+  _asyncReg = -1;
+
+  if (_asyncDone)
+    _asyncDone(status, _asyncValue);
+  return true;
+}
+
+/*******************************************************
+  Method: readPending
+  In: none
+  Out: true while an asynchronous read is in flight
+  Description: blocking calls must not be made while a
+  read is pending, the transport refuses them with
+  AS5600_BUSY.
+*******************************************************/
+template <class Bus>
+bool AMS_5600_Driver<Bus>::readPending()
+{
+  return _asyncReg != -1;
+}
+
+/*******************************************************
+  Method: asyncStatus
+  In: none
+  Out: status of the last completed asynchronous read
+  Description: see poll.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::asyncStatus()
+{
+  return _asyncStatus;
+}
+
+/*******************************************************
+  Method: asyncValue
+  In: none
+  Out: value of the last successful asynchronous read
+  Description: see poll.
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::asyncValue()
+{
+  return _asyncValue;
+}
+
+/*******************************************************
+  Method: startTwoBytesRead
+  In: register to read, completion callback
+  Out: AS5600_OK if started, AS5600_BUSY otherwise
+  Description: asynchronous counterpart of
+  readTwoBytesTogether.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::startTwoBytesRead(int addr_in, AS5600_ReadCallback done)
+{
+  if (_asyncReg != -1)
+    return AS5600_BUSY;
+
+  uint8_t reg = addr_in;
+  AS5600_Status status;
+  if ((_streamReg == -1) || (_pointer != addr_in))
+    status = bus.startWriteRead(_ams5600_Address, &reg, 1, _asyncData, 2);
+  else
+    status = bus.startWriteRead(_ams5600_Address, 0, 0, _asyncData, 2);
+  if (status != AS5600_OK)
+    return status;
+
+  // the pointer is only known again once the read completes
+  _pointer = -1;
+  _asyncReg = addr_in;
+  _asyncDone = done;
+  return AS5600_OK;
+}
+
+/*******************************************************
+  Method: readOneByte
+  In: register to read
+  Out: data read from i2c, -1 on failure
+  Description: reads one byte register from i2c
+*******************************************************/
+template <class Bus>
+int AMS_5600_Driver<Bus>::readOneByte(int in_adr)
+{
+  int retVal = -1;
+  uint8_t data;
+  if (readOneByte(in_adr, data) == AS5600_OK)
+    retVal = data;
+
+  return retVal;
+}
+
+/*******************************************************
+  Method: readOneByte
+  In: register to read, variable to store it in
+  Out: status of the transaction
+  Description: reads one byte register from i2c
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::readOneByte(int in_adr, uint8_t &value)
+{
+  return readBytes(in_adr, &value, 1);
+}
+
+/*******************************************************
+  Method: readTwoBytesTogether
+  In: two registers to read
+  Out: data read from i2c as a word, 0 on failure
+  Description: reads two bytes register from i2c
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::readTwoBytesTogether(int addr_in)
+{
+  word retVal = 0;
+  readTwoBytesTogether(addr_in, retVal);
+  return retVal;
+}
+
+/*******************************************************
+  Method: readTwoBytesTogether
+  In: two registers to read, variable to store them in
+  Out: status of the transaction
+  Description: reads two bytes register from i2c, value
+  is left untouched on failure
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::readTwoBytesTogether(int addr_in, word &value)
+{
+
+  // use only for Angle, Raw Angle and Magnitude
+
+  // read 2 bytes together to prevent getting inconsistent
+  //    data while the encoder is moving
+  // according to the datasheet the address is automatically incremented
+  //    but only for Angle, Raw Angle and Magnitude
+  // the title says it's auto, but the paragraph after it
+  //    says it does NOT
+  // tested and it does auto increment
+  
+  // PAGE 13: https://ams.com/documents/20143/36005/AS5600_DS000365_5-00.pdf
+  // Automatic Increment of the Address Pointer for ANGLE, RAW ANGLE and MAGNITUDE Registers
+  // These are special registers which suppress the automatic
+  // increment of the address pointer on reads, so a re-read of these
+  // registers requires no I²C write command to reload the address
+  // pointer. This special treatment of the pointer is effective only if
+  // the address pointer is set to the high byte of the register.
+
+  // in streaming mode the address write is skipped while the
+  //    device pointer still sits on the high byte of addr_in
+
+  /* Read 2 Bytes */
+  uint8_t reg = addr_in;
+  uint8_t data[2];
+  if ((_streamReg == -1) || (_pointer != addr_in))
+    _status = bus.writeRead(_ams5600_Address, &reg, 1, data, 2);
+  else
+    _status = bus.read(_ams5600_Address, data, 2);
+
+  if (_status != AS5600_OK) {
+    _pointer = -1;
+    return _status;
+  }
+
+  if ((addr_in == _addr_raw_angle) || (addr_in == _addr_angle) || (addr_in == _addr_magnitude))
+    _pointer = addr_in;
+  else
+    _pointer = -1;
+
+  int highByte = data[0];
+  int lowByte  = data[1];
+
+  // in case newer version of IC used the same address to
+  //    store something else, get only the 3 bits
+  //return ( ( highByte & 0b111 ) << 8 ) | lowByte;
+
+  // but in case newer version has higher resolution
+  //    we're good to go
+  value = ( highByte << 8 ) | lowByte;
+  return _status;
+}
+
+/*******************************************************
+  Method: shadowReady
+  In: none
+  Out: true if the shadow copy holds the device values
+  Description: fills the shadow copy on first use.
+*******************************************************/
+template <class Bus>
+bool AMS_5600_Driver<Bus>::shadowReady()
+{
+  return _shadowValid || (refreshShadow() == 1);
+}
+
+/*******************************************************
+  Method: updateConf
+  In: field position, field mask and new field value
+  Out: status of the transaction
+  Description: read-modify-write of a CONF field against
+  the shadow copy. Writes nothing if the value is
+  unchanged, one byte if only one byte changed, both
+  in one transaction otherwise.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::updateConf(uint8_t shift, word mask, word value)
+{
+  if (!shadowReady())
+    return _status;
+
+  word conf = (_shadow.conf & ~(mask << shift)) | ((value & mask) << shift);
+  word changed = conf ^ _shadow.conf;
+  if (changed == 0)
+    return AS5600_OK;
+
+  if ((changed & 0xff00) && (changed & 0x00ff))
+    writeTwoBytes(_addr_conf, conf);
+  else if (changed & 0xff00)
+    writeOneByte(_addr_conf, highByte(conf));
+  else
+    writeOneByte(_addr_conf+1, lowByte(conf));
+
+  if (_status == AS5600_OK)
+    _shadow.conf = conf;
+  else
+    _shadowValid = false;
+  return _status;
+}
+
+/*******************************************************
+  Method: confField
+  In: field position and mask
+  Out: value of the field, 0 if CONF cannot be read
+  Description: extracts a CONF field from the shadow
+  copy.
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::confField(uint8_t shift, word mask)
+{
+  return (getConf() >> shift) & mask;
+}
+
+/*******************************************************
+  Method: readTwoBytesBurst
+  In: two registers to read
+  Out: data read from i2c as a word, 0 on failure
+  Description: reads a two byte register in one burst.
+*******************************************************/
+template <class Bus>
+word AMS_5600_Driver<Bus>::readTwoBytesBurst(int addr_in)
+{
+  uint8_t data[2];
+  if (readBytes(addr_in, data, 2) != AS5600_OK)
+    return 0;
+  return (data[0] << 8) | data[1];
+}
+
+/*******************************************************
+  Method: readBytes
+  In: first register to read, buffer and byte count
+  Out: status of the transaction
+  Description: reads consecutive registers in one burst,
+  relying on the auto-incremented address pointer.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::readBytes(int addr_in, uint8_t *data, uint8_t len)
+{
+  uint8_t reg = addr_in;
+  _pointer = -1;
+  _status = bus.writeRead(_ams5600_Address, &reg, 1, data, len);
+  return _status;
+}
+
+/*******************************************************
+  Method: startHoldsPointer
+  In: register address
+  Out: true if a read addressed there does not
+  auto-increment the pointer
+*******************************************************/
+template <class Bus>
+bool AMS_5600_Driver<Bus>::startHoldsPointer(uint8_t addr_in)
+{
+  for (uint8_t i = 0; i < AS5600_REGISTER_COUNT; i++)
+    if (as5600_register((AS5600_Register)i).addr == addr_in)
+      return as5600_register((AS5600_Register)i).holdsPointer;
+  return false;
+}
+
+/*******************************************************
+  Method: burstStart
+  In: first and last address a burst has to cover
+  Out: address the burst is read from
+  Description: moves the start one byte down when the
+  burst would otherwise start on a register holding the
+  pointer and read past it.
+*******************************************************/
+template <class Bus>
+uint8_t AMS_5600_Driver<Bus>::burstStart(uint8_t first, uint8_t last)
+{
+  if (startHoldsPointer(first) && (last > first + 1))
+    return first - 1;
+  return first;
+}
+
+/*******************************************************
+  Method: decodeSample
+  In: registers 0x0b-0x0f, sample to fill
+  Out: none
+  Description: splits the STATUS bits and the two
+  angles out of a burst starting at 0x0b.
+*******************************************************/
+template <class Bus>
+void AMS_5600_Driver<Bus>::decodeSample(const uint8_t *data, Sample &sample)
+{
+  sample.status          = data[0];
+  sample.magnetDetected  = (data[0] & 0x20) != 0;
+  sample.magnetTooWeak   = (data[0] & 0x10) != 0;
+  sample.magnetTooStrong = (data[0] & 0x08) != 0;
+  sample.rawAngle = (data[_addr_raw_angle - _addr_status] << 8) | data[_addr_raw_angle + 1 - _addr_status];
+  sample.angle    = (data[_addr_angle - _addr_status] << 8) | data[_addr_angle + 1 - _addr_status];
+}
+
+/*******************************************************
+  Method: writeOneByte
+  In: address and data to write
+  Out: none
+  Description: writes one byte to a i2c register
+*******************************************************/
+template <class Bus>
+void AMS_5600_Driver<Bus>::writeOneByte(int adr_in, int dat_in)
+{
+  uint8_t data[2] = { (uint8_t)adr_in, (uint8_t)dat_in };
+  _status = bus.write(_ams5600_Address, data, 2);
+  _pointer = -1;
+  noteWrite(adr_in, 1);
+}
+
+/*******************************************************
+  Method: writeTwoBytes
+  In: register address and value to write
+  Out: status of the transaction
+  Description: writes the high and low byte of a two
+  byte register in one transaction.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::writeTwoBytes(int adr_in, word dat_in)
+{
+  uint8_t data[2] = { highByte(dat_in), lowByte(dat_in) };
+  return writeBytes(adr_in, data, 2);
+}
+
+/*******************************************************
+  Method: writeBytes
+  In: first register address, data and byte count
+  Out: status of the transaction
+  Description: writes consecutive registers in one
+  burst, relying on the auto-incremented address
+  pointer. At most AS5600_TX_MAX - 1 bytes.
+*******************************************************/
+template <class Bus>
+AS5600_Status AMS_5600_Driver<Bus>::writeBytes(int adr_in, const uint8_t *dat_in, uint8_t len)
+{
+  uint8_t data[AS5600_TX_MAX];
+  if (len > AS5600_TX_MAX - 1) {
+    _status = AS5600_NACK;
+    return _status;
+  }
+  data[0] = adr_in;
+  for (uint8_t i = 0; i < len; i++)
+    data[i + 1] = dat_in[i];
+  _status = bus.write(_ams5600_Address, data, len + 1);
+  _pointer = -1;
+  noteWrite(adr_in, len);
+  return _status;
+}
+
+/*******************************************************
+  Method: noteWrite
+  In: first register address and byte count written
+  Out: none
+  Description: remembers when ZPOS, MPOS, MANG or CONF
+  (0x01-0x08) were last written. Counted whatever the
+  outcome: a NACKed write may still have reached some
+  registers.
+*******************************************************/
+template <class Bus>
+void AMS_5600_Driver<Bus>::noteWrite(int adr_in, uint8_t len)
+{
+  if ((adr_in + len > _addr_zpos) && (adr_in <= _addr_conf + 1)) {
+    _configWriteUs = micros();
+    _configWritten = true;
+  }
+}
+
+/*******************************************************
+  Method: waitBeforeBurn
+  In: none
+  Out: none
+  Description: waits until at least 1 ms has passed
+  since the last configuration write, as the datasheet
+  programming procedure requires before a BURN command.
+*******************************************************/
+template <class Bus>
+void AMS_5600_Driver<Bus>::waitBeforeBurn()
+{
+  if (!_configWritten)
+    return;
+  unsigned long elapsed = micros() - _configWriteUs;
+  if (elapsed < _burnSettleUs)
+    delayMicroseconds(_burnSettleUs - elapsed);
+  _configWritten = false;
+}
+
+/**********  END OF AMS 5600 CLASS *****************/
+
+#endif
@@ -0,0 +1,465 @@
+/****************************************************
+  AMS 5600 host-side bus timing model
+  File: AS5600_timing_model.h
+
+  Description:  Simulated port, pins and delays for
+  AS5600_BitBangBus and AS5600_MultiBus, plus a simulated AS5600 that
+  answers on the bus and checks every edge it sees
+  against the I2C timing limits. Meant for host builds:
+  run the real bit-bang engine against the model and
+  inspect the edge trace, the violation count and the
+  elapsed CPU cycles.
+
+  Time is counted in CPU cycles. Each pin access costs
+  opCycles, each delay its template argument; loop
+  overhead of the real code only lengthens phases, so a
+  trace that meets the minimum times here meets them on
+  the target too.
+
+  AS5600_SimSlowPin delays each rising edge by a few
+  reads, to exercise clock stretching.
+
+  Usage:
+    typedef AS5600_SimPin<0, 1> Sda;
+    typedef AS5600_SimPin<0, 0> Scl;
+    AS5600_SimDevice dev(0, 1);   // SCL bit 0, SDA bit 1
+    AS5600_SimPort<0>::attach(&dev);
+    AMS_5600_Driver<AS5600_BitBangBus<Sda, Scl, AS5600_SimDelay<8> > > ams;
+    ams.getRawAngle();
+    // dev.violations, dev.firstViolation, AS5600_SimPort<0>::now
+***************************************************/
+
+#ifndef AS5600_TIMING_MODEL_h
+#define AS5600_TIMING_MODEL_h
+
+#include <stdint.h>
+
+// minimum times in ns, I2C specification UM10204 table 10
+struct AS5600_I2cTiming
+{
+  unsigned int tLow;   // SCL low
+  unsigned int tHigh;  // SCL high
+  unsigned int tSuSta; // repeated START setup
+  unsigned int tHdSta; // START hold
+  unsigned int tSuDat; // data setup
+  unsigned int tSuSto; // STOP setup
+  unsigned int tBuf;   // bus free between STOP and START
+};
+
+static const AS5600_I2cTiming AS5600_I2C_STANDARD       = { 4700, 4000, 4700, 4000, 250, 4000, 4700 };
+static const AS5600_I2cTiming AS5600_I2C_FAST           = { 1300,  600,  600,  600, 100,  600, 1300 };
+static const AS5600_I2cTiming AS5600_I2C_FAST_MODE_PLUS = {  500,  260,  260,  260,  50,  260,  500 };
+
+struct AS5600_SimEdge
+{
+  unsigned long time; // CPU cycles
+  uint8_t levels;     // port levels after the edge
+};
+
+/*******************************************************
+  Simulated AS5600 on one SCL/SDA bit pair. Decodes the
+  bus like the real device, drives ACK and read data,
+  and records timing and protocol violations.
+*******************************************************/
+class AS5600_SimDevice
+{
+public:
+
+  AS5600_SimDevice(uint8_t sclBit, uint8_t sdaBit, const AS5600_I2cTiming &timing = AS5600_I2C_FAST_MODE_PLUS)
+    : sclMask(1 << sclBit), sdaMask(1 << sdaBit), timing(timing), pointer(0),
+      violations(0), firstViolation(0), starts(0), stops(0),
+      _state(IDLE), _drive(false), _lastSclRise(0), _lastSclFall(0), _lastSdaChange(0),
+      _lastStart(0), _lastStop(0), _startInHigh(false), _sdaSinceFall(false), _busFree(true)
+  {
+    for (int i = 0; i < 256; i++)
+      regs[i] = 0;
+  }
+
+  // true while the device pulls SDA low
+  bool drivesLow() const { return _drive; }
+
+  // called by the port on every change of the line levels
+  void edge(unsigned long now, uint8_t before, uint8_t after, unsigned long cpuMhz)
+  {
+    bool sclBefore = before & sclMask, sclAfter = after & sclMask;
+    bool sdaBefore = before & sdaMask, sdaAfter = after & sdaMask;
+
+    if (sclBefore != sclAfter) {
+      if (sclAfter)
+        sclRise(now, sdaAfter, cpuMhz);
+      else
+        sclFall(now, cpuMhz);
+    } else if (sdaBefore != sdaAfter) {
+      if (sclAfter) {
+        if (sdaAfter)
+          stopCondition(now, cpuMhz);
+        else
+          startCondition(now, cpuMhz);
+      } else {
+        _lastSdaChange = now;
+        _sdaSinceFall = true;
+      }
+    }
+  }
+
+  uint8_t sclMask;
+  uint8_t sdaMask;
+  AS5600_I2cTiming timing;
+
+  uint8_t regs[256];
+  uint8_t pointer;
+
+  unsigned long violations;
+  const char *firstViolation;
+  unsigned long starts;
+  unsigned long stops;
+
+private:
+
+  enum State { IDLE, RX, ACK_OUT, TX, ACK_IN, IGNORE };
+
+  State _state;
+  bool _drive;
+  bool _isAddr;
+  bool _readMode;
+  bool _firstData;
+  bool _masterAck;
+  uint8_t _shift;
+  uint8_t _bits;
+  uint8_t _readStart;
+
+  unsigned long _lastSclRise;
+  unsigned long _lastSclFall;
+  unsigned long _lastSdaChange;
+  unsigned long _lastStart;
+  unsigned long _lastStop;
+  bool _startInHigh;
+  bool _sdaSinceFall;
+  bool _busFree;
+
+  void check(bool ok, const char *what)
+  {
+    if (ok)
+      return;
+    if (violations++ == 0)
+      firstViolation = what;
+  }
+
+  static unsigned long cycles(unsigned int ns, unsigned long cpuMhz)
+  {
+    return ((unsigned long)ns * cpuMhz + 999) / 1000;
+  }
+
+  static bool holdsPointer(uint8_t reg)
+  {
+    return (reg == 0x0c) || (reg == 0x0e) || (reg == 0x1b);
+  }
+
+  uint8_t nextReadByte()
+  {
+    uint8_t value = regs[pointer];
+    if (holdsPointer(_readStart) && (pointer == _readStart + 1))
+      pointer = _readStart;
+    else
+      pointer++;
+    return value;
+  }
+
+  // START and STOP begin with an SCL rise the device has already taken as bit 0
+  bool atByteBoundary() const
+  {
+    return (_state == IDLE) || (_state == IGNORE) || ((_state == RX) && (_bits <= 1));
+  }
+
+  void startCondition(unsigned long now, unsigned long cpuMhz)
+  {
+    starts++;
+    if (_busFree) {
+      if (stops > 0)
+        check(now - _lastStop >= cycles(timing.tBuf, cpuMhz), "tBUF");
+    } else
+      check(now - _lastSclRise >= cycles(timing.tSuSta, cpuMhz), "tSU;STA");
+    check(atByteBoundary(),
+          "START inside a byte");
+    _lastStart = now;
+    _startInHigh = true;
+    _busFree = false;
+    _state = RX;
+    _isAddr = true;
+    _bits = 0;
+    _shift = 0;
+    _drive = false;
+  }
+
+  void stopCondition(unsigned long now, unsigned long cpuMhz)
+  {
+    stops++;
+    check(now - _lastSclRise >= cycles(timing.tSuSto, cpuMhz), "tSU;STO");
+    check(atByteBoundary(),
+          "STOP inside a byte");
+    _lastStop = now;
+    _busFree = true;
+    _state = IDLE;
+    _drive = false;
+  }
+
+  void sclRise(unsigned long now, bool sda, unsigned long cpuMhz)
+  {
+    if (!_busFree) {
+      check(now - _lastSclFall >= cycles(timing.tLow, cpuMhz), "tLOW");
+      if (_sdaSinceFall)
+        check(now - _lastSdaChange >= cycles(timing.tSuDat, cpuMhz), "tSU;DAT");
+    }
+    _lastSclRise = now;
+
+    if (_state == RX) {
+      _shift = (_shift << 1) | (sda ? 1 : 0);
+      _bits++;
+    } else if (_state == ACK_IN) {
+      _masterAck = !sda;
+    }
+  }
+
+  void sclFall(unsigned long now, unsigned long cpuMhz)
+  {
+    check(now - _lastSclRise >= cycles(timing.tHigh, cpuMhz), "tHIGH");
+    if (_startInHigh)
+      check(now - _lastStart >= cycles(timing.tHdSta, cpuMhz), "tHD;STA");
+    _startInHigh = false;
+    _sdaSinceFall = false;
+    _lastSclFall = now;
+
+    switch (_state) {
+      case RX:
+        if (_bits < 8)
+          break;
+        if (_isAddr) {
+          _isAddr = false;
+          if ((_shift >> 1) != 0x36) {
+            _state = IGNORE;
+            break;
+          }
+          _readMode = _shift & 1;
+          _firstData = true;
+        } else if (_firstData) {
+          pointer = _shift;
+          _firstData = false;
+        } else {
+          regs[pointer++] = _shift;
+        }
+        _drive = true;
+        _state = ACK_OUT;
+        break;
+
+      case ACK_OUT:
+        _drive = false;
+        _bits = 0;
+        _shift = 0;
+        if (_readMode) {
+          _readStart = pointer;
+          _shift = nextReadByte();
+          _drive = !(_shift & 0x80);
+          _state = TX;
+        } else {
+          _state = RX;
+        }
+        break;
+
+      case TX:
+        _bits++;
+        if (_bits < 8) {
+          _drive = !(_shift & (0x80 >> _bits));
+        } else {
+          _drive = false;
+          _state = ACK_IN;
+        }
+        break;
+
+      case ACK_IN:
+        if (_masterAck) {
+          _bits = 0;
+          _shift = nextReadByte();
+          _drive = !(_shift & 0x80);
+          _state = TX;
+        } else {
+          _state = IGNORE;
+        }
+        break;
+
+      default:
+        break;
+    }
+  }
+};
+
+/*******************************************************
+  Simulated 8 bit port with pull-ups. The master pulls
+  lines low through masterLow, attached devices through
+  their SDA drivers; the level is the wired AND.
+*******************************************************/
+template <int Id>
+class AS5600_SimPort
+{
+public:
+
+  static const uint8_t maxDevices = 8;
+  static const unsigned int maxTrace = 1024;
+
+  static void attach(AS5600_SimDevice *device)
+  {
+    if (deviceCount < maxDevices)
+      devices[deviceCount++] = device;
+  }
+
+  static void reset()
+  {
+    deviceCount = 0;
+    masterLow = 0;
+    levels = 0xff;
+    now = 0;
+    traceLen = 0;
+  }
+
+  static void drive(uint8_t mask, bool low)
+  {
+    now += opCycles;
+    if (low)
+      masterLow |= mask;
+    else
+      masterLow &= ~mask;
+    settle();
+  }
+
+  static uint8_t sample()
+  {
+    now += readCycles;
+    return levels;
+  }
+
+  static void advance(unsigned long cycles) { now += cycles; }
+
+  static uint8_t masterLow;
+  static uint8_t levels;
+  static unsigned long now;
+  static unsigned long cpuMhz;
+  static unsigned long opCycles;   // cost of one pin write (sbi/cbi)
+  static unsigned long readCycles; // cost of one port read
+  static AS5600_SimEdge trace[maxTrace];
+  static unsigned int traceLen;
+
+private:
+
+  static AS5600_SimDevice *devices[maxDevices];
+  static uint8_t deviceCount;
+
+  // devices react to an edge instantly, repeat until the lines are stable
+  static void settle()
+  {
+    for (int pass = 0; pass < 4; pass++) {
+      uint8_t low = masterLow;
+      for (uint8_t i = 0; i < deviceCount; i++)
+        if (devices[i]->drivesLow())
+          low |= devices[i]->sdaMask;
+      uint8_t after = ~low;
+      if (after == levels)
+        return;
+      uint8_t before = levels;
+      levels = after;
+      if (traceLen < maxTrace) {
+        trace[traceLen].time = now;
+        trace[traceLen].levels = after;
+        traceLen++;
+      }
+      for (uint8_t i = 0; i < deviceCount; i++)
+        devices[i]->edge(now, before, after, cpuMhz);
+    }
+  }
+};
+
+template <int Id> uint8_t AS5600_SimPort<Id>::masterLow = 0;
+template <int Id> uint8_t AS5600_SimPort<Id>::levels = 0xff;
+template <int Id> unsigned long AS5600_SimPort<Id>::now = 0;
+template <int Id> unsigned long AS5600_SimPort<Id>::cpuMhz = 16;
+template <int Id> unsigned long AS5600_SimPort<Id>::opCycles = 2;
+template <int Id> unsigned long AS5600_SimPort<Id>::readCycles = 1;
+template <int Id> AS5600_SimEdge AS5600_SimPort<Id>::trace[AS5600_SimPort<Id>::maxTrace];
+template <int Id> unsigned int AS5600_SimPort<Id>::traceLen = 0;
+template <int Id> AS5600_SimDevice *AS5600_SimPort<Id>::devices[AS5600_SimPort<Id>::maxDevices];
+template <int Id> uint8_t AS5600_SimPort<Id>::deviceCount = 0;
+
+// pin policy for AS5600_BitBangBus on bit Bit of simulated port Id
+template <int Id, uint8_t Bit>
+struct AS5600_SimPin
+{
+  static const uint8_t mask = 1 << Bit;
+
+  static inline void begin()   { AS5600_SimPort<Id>::drive(mask, false); }
+  static inline void low()     { AS5600_SimPort<Id>::drive(mask, true); }
+  static inline void release() { AS5600_SimPort<Id>::drive(mask, false); }
+  static inline bool read()    { return AS5600_SimPort<Id>::sample() & mask; }
+};
+
+/*******************************************************
+  Pin with a slow rising edge: after release() the line
+  still reads low for RiseReads reads, as with a large
+  bus capacitance or a device stretching the clock, and
+  rises right after the last of them.
+*******************************************************/
+template <int Id, uint8_t Bit, uint8_t RiseReads = 1>
+struct AS5600_SimSlowPin
+{
+  static const uint8_t mask = 1 << Bit;
+
+  static inline void begin()
+  {
+    pending = 0;
+    AS5600_SimPort<Id>::drive(mask, false);
+  }
+
+  static inline void low()
+  {
+    pending = 0;
+    AS5600_SimPort<Id>::drive(mask, true);
+  }
+
+  static inline void release()
+  {
+    if (!(AS5600_SimPort<Id>::masterLow & mask) || pending)
+      return;
+    pending = RiseReads;
+    if (!pending)
+      AS5600_SimPort<Id>::drive(mask, false);
+  }
+
+  static inline bool read()
+  {
+    bool level = AS5600_SimPort<Id>::sample() & mask;
+    if (pending && (--pending == 0))
+      AS5600_SimPort<Id>::drive(mask, false);
+    return level;
+  }
+
+  static uint8_t pending; // reads left until the line rises
+};
+
+template <int Id, uint8_t Bit, uint8_t RiseReads>
+uint8_t AS5600_SimSlowPin<Id, Bit, RiseReads>::pending = 0;
+
+// port policy for AS5600_MultiBus on simulated port Id
+template <int Id>
+struct AS5600_SimPortLines
+{
+  static inline void begin(uint8_t mask)   { AS5600_SimPort<Id>::drive(mask, false); }
+  static inline void low(uint8_t mask)     { AS5600_SimPort<Id>::drive(mask, true); }
+  static inline void release(uint8_t mask) { AS5600_SimPort<Id>::drive(mask, false); }
+  static inline uint8_t read()             { return AS5600_SimPort<Id>::sample(); }
+};
+
+// delay policy advancing the simulated clock
+template <unsigned long Cycles, int Id = 0>
+struct AS5600_SimDelay
+{
+  static inline void half() { AS5600_SimPort<Id>::advance(Cycles); }
+};
+
+#endif
@@ -0,0 +1,183 @@
+/****************************************************
+  AMS 5600 position tracker with prediction
+  File: AS5600_tracker.h
+
+  Description:  AS5600_Tracker estimates continuous
+  position and velocity from timestamped raw angles
+  with an alpha-beta filter (a constant-velocity model
+  with fixed gains) and extrapolates them to any later
+  time. A servo loop can then ask for the position at
+  the moment it actuates, hiding the age of the last
+  I2C read.
+
+  Each raw angle is compared with the predicted one,
+  the residual taken the short way round the turn, so
+  the estimate unwraps itself and keeps tracking while
+  the shaft turns up to half a revolution per sample
+  beyond the prediction. Position is in counts, 4096
+  per turn, velocity in counts/s, both with 16
+  fraction bits (AS5600_Fixed). No float and no
+  division per sample.
+
+  setTrackingIndex() sets the gains of the steady-state
+  Kalman filter for a given ratio of process to
+  measurement noise; it uses float once, at setup.
+
+  Usage:
+    AS5600_Tracker tracker;
+    tracker.read(ams5600);                         // every sample
+    AS5600_Fixed at = tracker.predict(micros() + 150);
+    long counts = at >> 16;
+***************************************************/
+
+#ifndef AS5600_TRACKER_h
+#define AS5600_TRACKER_h
+
+#include <Arduino.h>
+#include <math.h>
+#include "AS5600_bus.h"
+#include "AS5600_units.h"
+#include "AS5600_velocity.h"
+
+class AS5600_Tracker
+{
+public:
+
+  AS5600_Tracker(long alpha = AS5600_DEFAULT_ALPHA, long beta = AS5600_DEFAULT_BETA)
+    : _alpha(alpha), _beta(beta)
+  {
+    reset();
+  }
+
+  // the next sample starts tracking again, at rest
+  void reset()
+  {
+    _started = false;
+    _position = 0;
+    _velocity = 0;
+    _lastUs = 0;
+  }
+
+  // gains with 16 fraction bits, 0 to AS5600_FIXED_ONE
+  void setGains(long alpha, long beta)
+  {
+    _alpha = alpha;
+    _beta = beta;
+  }
+
+  /*******************************************************
+    Method: setTrackingIndex
+    In: tracking index, acceleration noise * T^2 /
+        measurement noise, both as standard deviations
+        and T the sample interval
+    Out: none
+    Description: gains of the steady-state constant-
+    velocity Kalman filter (Kalata's relations). Larger
+    values follow manoeuvres faster, smaller ones
+    smooth more.
+  *******************************************************/
+  void setTrackingIndex(float lambda)
+  {
+    float r = (4 + lambda - sqrtf(8 * lambda + lambda * lambda)) / 4;
+    float alpha = 1 - r * r;
+    float beta = 2 * (2 - alpha) - 4 * sqrtf(1 - alpha);
+    setGains((long)(alpha * AS5600_FIXED_ONE + 0.5f), (long)(beta * AS5600_FIXED_ONE + 0.5f));
+  }
+
+  /*******************************************************
+    Method: update
+    In: raw angle, micros() when it was sampled
+    Out: none
+    Description: predicts to us, then corrects position
+    by alpha and velocity by beta / dt times the
+    residual. The first sample starts tracking from
+    there at rest; samples with the same timestamp are
+    ignored.
+  *******************************************************/
+  void update(word rawAngle, unsigned long us)
+  {
+    AS5600_Fixed measured = (AS5600_Fixed)(rawAngle & (AS5600_COUNTS_PER_TURN - 1)) << 16;
+    if (!_started) {
+      _position = measured;
+      _velocity = 0;
+      _lastUs = us;
+      _started = true;
+      return;
+    }
+    uint32_t dt = us - _lastUs;
+    if (dt == 0)
+      return;
+    _rate.update(dt);
+
+    AS5600_Fixed predicted = _position + as5600_advance(_velocity, dt);
+    AS5600_Fixed residual = measured - (predicted & (TURN - 1));
+    if (residual >= TURN / 2)
+      residual -= TURN;
+    else if (residual < -TURN / 2)
+      residual += TURN;
+
+    _position = predicted + as5600_mulFixed(residual, _alpha);
+    _velocity += as5600_mulFixed(as5600_mulFixed(residual, _beta), _rate.perSecond());
+    _lastUs = us;
+  }
+
+  /*******************************************************
+    Method: read
+    In: driver to read the raw angle from
+    Out: status of the transaction
+    Description: timestamps and reads the raw angle and
+    updates; nothing changes if the read failed.
+  *******************************************************/
+  template <class Driver>
+  AS5600_Status read(Driver &driver)
+  {
+    unsigned long us = micros();
+    word rawAngle;
+    AS5600_Status status = driver.readRawAngle(rawAngle);
+    if (status == AS5600_OK)
+      update(rawAngle, us);
+    return status;
+  }
+
+  /*******************************************************
+    Method: predict
+    In: micros() to extrapolate to
+    Out: position in counts, 16 fraction bits
+    Description: position at us at the current velocity
+    estimate. Times before the last sample give the
+    estimate at the last sample.
+  *******************************************************/
+  AS5600_Fixed predict(unsigned long us) const
+  {
+    long ahead = us - _lastUs;
+    if (ahead <= 0)
+      return _position;
+    return _position + as5600_advance(_velocity, ahead);
+  }
+
+  // predicted raw angle at us, rounded, 0 to 4095
+  word predictAngle(unsigned long us) const
+  {
+    return ((predict(us) + (AS5600_FIXED_ONE / 2)) >> 16) & (AS5600_COUNTS_PER_TURN - 1);
+  }
+
+  // estimates at the last sample: counts and counts/s, 16 fraction bits
+  AS5600_Fixed position() const { return _position; }
+  AS5600_Fixed velocity() const { return _velocity; }
+  unsigned long lastSample() const { return _lastUs; }
+
+private:
+
+  // one turn with 16 fraction bits
+  static const AS5600_Fixed TURN = (AS5600_Fixed)AS5600_COUNTS_PER_TURN << 16;
+
+  long _alpha;
+  long _beta;
+  bool _started;
+  AS5600_Fixed _position;
+  AS5600_Fixed _velocity;
+  unsigned long _lastUs;
+  AS5600_Reciprocal _rate; // of the last sample interval
+};
+
+#endif
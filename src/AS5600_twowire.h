@@ -0,0 +1,93 @@
+/****************************************************
+  AMS 5600 hardware I2C transport for Arduino platform
+  File: AS5600_twowire.h
+
+  Description:  AS5600_TwoWireBus drives the sensor
+  through a hardware TwoWire instance. Kept out of
+  AS5600_softwire.h so sketches that only bit-bang do
+  not pull in the Wire library.
+
+  Usage:
+    AMS_5600_Driver<AS5600_TwoWireBus> ams5600(Wire);
+***************************************************/
+
+#ifndef AS5600_TWOWIRE_h
+#define AS5600_TWOWIRE_h
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "AS5600_bus.h"
+
+class AS5600_TwoWireBus
+{
+public:
+
+  AS5600_TwoWireBus(TwoWire &wire) : _wire(wire)
+  {
+    setDeadline(AS5600_DEFAULT_DEADLINE_US);
+  }
+
+  AS5600_Status write(uint8_t addr, const uint8_t *data, uint8_t len)
+  {
+    _wire.beginTransmission(addr);
+    _wire.write(data, len);
+    switch (_wire.endTransmission()) {
+      case 0:
+        return AS5600_OK;
+      case 5:
+        return AS5600_TIMEOUT;
+      default:
+        return AS5600_NACK;
+    }
+  }
+
+  AS5600_Status read(uint8_t addr, uint8_t *data, uint8_t len)
+  {
+    uint8_t count = _wire.requestFrom(addr, len);
+    for (uint8_t i = 0; i < count; i++)
+      data[i] = _wire.read();
+
+    if (count == len)
+      return AS5600_OK;
+#if defined(WIRE_HAS_TIMEOUT)
+    if (_wire.getWireTimeoutFlag()) {
+      _wire.clearWireTimeoutFlag();
+      return AS5600_TIMEOUT;
+    }
+#endif
+    return count == 0 ? AS5600_NACK : AS5600_SHORT_READ;
+  }
+
+  // the read phase follows a repeated START, the bus is held throughout
+  AS5600_Status writeRead(uint8_t addr, const uint8_t *tx, uint8_t txLen,
+                          uint8_t *rx, uint8_t rxLen)
+  {
+    _wire.beginTransmission(addr);
+    _wire.write(tx, txLen);
+    switch (_wire.endTransmission(false)) {
+      case 0:
+        break;
+      case 5:
+        return AS5600_TIMEOUT;
+      default:
+        return AS5600_NACK;
+    }
+    return read(addr, rx, rxLen);
+  }
+
+  // cores without WIRE_HAS_TIMEOUT keep their own fixed timeout
+  void setDeadline(unsigned long us)
+  {
+#if defined(WIRE_HAS_TIMEOUT)
+    _wire.setWireTimeout(us, true);
+#else
+    (void)us;
+#endif
+  }
+
+private:
+
+  TwoWire &_wire;
+};
+
+#endif
@@ -0,0 +1,99 @@
+/****************************************************
+  AMS 5600 angle unit conversions
+  File: AS5600_units.h
+
+  Description:  Conversions between 12-bit angle counts
+  (4096 per turn) and angular units. The integer ones
+  are constexpr, multiply-and-shift only (no branches,
+  no division, no float), so they fold at compile time
+  and cost one multiply at run time on MCUs without an
+  FPU. Each rounds to nearest, checked against the
+  exact ratio over its whole input range:
+
+    centidegrees  counts * 36000 / 4096 = counts * 1125 / 128, exact ratio
+    milliradians  counts * 2000 pi / 4096, rounded
+    turns         counts << (bits - 12), Q format
+
+  The float versions are for host builds and display.
+
+  Usage:
+    word cd = as5600_toCentidegrees(ams5600.getRawAngle()); // 0 to 35991
+    static_assert(as5600_fromCentidegrees(1800) == 205, "18 degrees");
+***************************************************/
+
+#ifndef AS5600_UNITS_h
+#define AS5600_UNITS_h
+
+#include <Arduino.h>
+
+// counts per turn of the 12 bit angle
+#define AS5600_COUNTS_PER_TURN 4096
+
+/*******************************************************
+  counts to centidegrees, rounded to nearest:
+  36000 / 4096 is exactly 1125 / 128
+*******************************************************/
+constexpr uint16_t as5600_toCentidegrees(uint16_t counts)
+{
+  return ((uint32_t)counts * 1125 + 64) >> 7;
+}
+
+/*******************************************************
+  centidegrees to counts, rounded to nearest:
+  4096 / 36000 = 128 / 1125, taken as 3817749 / 2^25.
+  No 32-bit product rounds all of 0 to 35999 right, so
+  this one multiplies in 64 bits; it is meant for
+  setpoints, not per-sample work
+*******************************************************/
+constexpr uint16_t as5600_fromCentidegrees(uint16_t centidegrees)
+{
+  return ((uint64_t)centidegrees * 3817749UL + (1UL << 24)) >> 25;
+}
+
+/*******************************************************
+  counts to milliradians, rounded to nearest:
+  2000 pi / 4096 = 1.53398..., taken as 100531 / 2^16
+*******************************************************/
+constexpr uint16_t as5600_toMilliradians(uint16_t counts)
+{
+  return ((uint32_t)counts * 100531UL + (1UL << 15)) >> 16;
+}
+
+/*******************************************************
+  milliradians to counts, rounded to nearest:
+  4096 / 2000 pi = 0.65189..., taken as 683565 / 2^20,
+  64-bit product for the same reason as above
+*******************************************************/
+constexpr uint16_t as5600_fromMilliradians(uint16_t milliradians)
+{
+  return ((uint64_t)milliradians * 683565UL + (1UL << 19)) >> 20;
+}
+
+/*******************************************************
+  counts to a fraction of a turn with Bits fraction
+  bits (12 to 31), e.g. as5600_toTurns<16>() gives Q16
+*******************************************************/
+template <uint8_t Bits>
+constexpr uint32_t as5600_toTurns(uint16_t counts)
+{
+  static_assert((Bits >= 12) && (Bits <= 31), "Q format needs 12 to 31 fraction bits");
+  return (uint32_t)counts << (Bits - 12);
+}
+
+// float versions, for host builds and display
+constexpr float as5600_toDegrees(uint16_t counts)
+{
+  return counts * (360.0f / AS5600_COUNTS_PER_TURN);
+}
+
+constexpr float as5600_toRadians(uint16_t counts)
+{
+  return counts * (6.283185307179586f / AS5600_COUNTS_PER_TURN);
+}
+
+constexpr uint16_t as5600_fromDegrees(float degrees)
+{
+  return (uint16_t)(degrees * (AS5600_COUNTS_PER_TURN / 360.0f) + 0.5f);
+}
+
+#endif
@@ -0,0 +1,267 @@
+/****************************************************
+  AMS 5600 velocity and acceleration estimator
+  File: AS5600_velocity.h
+
+  Description:  AS5600_Velocity turns timestamped
+  positions (e.g. AS5600_MultiTurn counts sampled by
+  AS5600_Sampler) into velocity in counts/s and
+  acceleration in counts/s^2, fixed point with 16
+  fraction bits (Q16.16 scaling, held in 64 bits so
+  thousands of RPM at 4096 counts per turn fit).
+
+  Three estimators:
+    AS5600_VEL_DIFFERENCE  last two samples, no lag, noisiest
+    AS5600_VEL_WINDOW      span of the last Window samples
+    AS5600_VEL_ALPHA_BETA  alpha-beta tracking filter
+
+  No float and no division per sample: 1/dt comes from
+  AS5600_Reciprocal, which refines the previous
+  reciprocal with Newton steps, so with a steady sample
+  rate each update costs a handful of multiplications.
+
+  Usage:
+    AS5600_Velocity<> speed(AS5600_VEL_ALPHA_BETA);
+    speed.update(position.position(), sample.us);
+    long countsPerSecond = speed.velocity() >> 16;
+***************************************************/
+
+#ifndef AS5600_VELOCITY_h
+#define AS5600_VELOCITY_h
+
+#include <Arduino.h>
+
+// 16 fraction bits, 64 bits wide
+typedef int64_t AS5600_Fixed;
+
+#define AS5600_FIXED_ONE 65536L
+
+// default alpha-beta gains, 16 fraction bits: alpha 1/4 and the
+// Benedict-Bordner beta = alpha^2 / (2 - alpha) = 1/28
+#define AS5600_DEFAULT_ALPHA (AS5600_FIXED_ONE / 4)
+#define AS5600_DEFAULT_BETA  2341
+
+enum AS5600_VelocityMode
+{
+  AS5600_VEL_DIFFERENCE = 0,
+  AS5600_VEL_WINDOW,
+  AS5600_VEL_ALPHA_BETA
+};
+
+// a * b, both with 16 fraction bits, without overflowing on large a
+inline AS5600_Fixed as5600_mulFixed(AS5600_Fixed a, AS5600_Fixed b)
+{
+  return (a >> 16) * b + (((a & 0xffff) * b) >> 16);
+}
+
+// distance covered in us microseconds at velocity per second, both with
+// 16 fraction bits
+inline AS5600_Fixed as5600_advance(AS5600_Fixed velocity, uint32_t us)
+{
+  // us in seconds with 32 fraction bits, 4295 = 2^32 / 1e6
+  uint64_t seconds = (uint64_t)us * 4295;
+  AS5600_Fixed moved = (velocity >> 16) * (AS5600_Fixed)seconds >> 16;
+  return moved + (((velocity & 0xffff) * (AS5600_Fixed)seconds) >> 32);
+}
+
+/*******************************************************
+  Reciprocal of a time interval in microseconds,
+  without dividing. inv approximates 2^32 / us; a new
+  interval first rescales inv by powers of two until
+  us * inv is within a factor 1.5 of 2^32, then Newton
+  steps inv = inv * (2 - us * inv) converge
+  quadratically: from an error of up to 1/2, five steps
+  reach the 2^-32 resolution. An unchanged interval
+  costs one multiplication.
+*******************************************************/
+struct AS5600_Reciprocal
+{
+  AS5600_Reciprocal() : inv(1UL << 22) {}
+
+  void update(uint32_t us)
+  {
+    if (us < 2)
+      return;
+    uint64_t e = (uint64_t)us * inv;
+    while ((e >= (3ULL << 31)) && (inv > 1)) {
+      inv >>= 1;
+      e = (uint64_t)us * inv;
+    }
+    while ((e < (1ULL << 31)) && (inv < (1UL << 31))) {
+      inv <<= 1;
+      e = (uint64_t)us * inv;
+    }
+    for (uint8_t i = 0; i < 5; i++) {
+      int64_t error = (int64_t)e - (1LL << 32);
+      if ((error < (int64_t)us) && (error > -(int64_t)us))
+        break; // within one step of inv
+      inv = ((uint64_t)inv * (((1ULL << 33) - e) >> 1)) >> 31;
+      e = (uint64_t)us * inv;
+    }
+  }
+
+  // 1e6 / us with 16 fraction bits: events per second
+  AS5600_Fixed perSecond() const
+  {
+    return (AS5600_Fixed)(((uint64_t)1000000UL * inv) >> 16);
+  }
+
+  uint32_t inv;
+};
+
+template <uint8_t Window = 8>
+class AS5600_Velocity
+{
+public:
+
+  static_assert((Window & (Window - 1)) == 0, "window must be a power of two");
+  static_assert((Window >= 2) && (Window <= 128), "window must be 2 to 128");
+
+  AS5600_Velocity(AS5600_VelocityMode mode = AS5600_VEL_DIFFERENCE)
+    : _mode(mode), _alpha(AS5600_DEFAULT_ALPHA), _beta(AS5600_DEFAULT_BETA)
+  {
+    reset();
+  }
+
+  void reset()
+  {
+    _count = 0;
+    _velocity = 0;
+    _acceleration = 0;
+  }
+
+  void setMode(AS5600_VelocityMode mode)
+  {
+    _mode = mode;
+    reset();
+  }
+
+  // alpha-beta gains with 16 fraction bits, 0 to AS5600_FIXED_ONE
+  void setGains(long alpha, long beta)
+  {
+    _alpha = alpha;
+    _beta = beta;
+  }
+
+  /*******************************************************
+    Method: update
+    In: position in counts, micros() of the sample
+    Out: none
+    Description: feeds one sample. Velocity needs two
+    samples, acceleration three (Window + 2 in
+    AS5600_VEL_WINDOW); until then they read 0. Samples
+    with the same timestamp are ignored.
+  *******************************************************/
+  void update(long position, unsigned long us)
+  {
+    if (_count == 0) {
+      start(position, us);
+      return;
+    }
+    uint32_t dt = us - _lastUs;
+    if (dt == 0)
+      return;
+    _rate.update(dt);
+
+    AS5600_Fixed velocity;
+    switch (_mode) {
+      case AS5600_VEL_WINDOW:
+        velocity = window(position, us);
+        break;
+      case AS5600_VEL_ALPHA_BETA:
+        velocity = alphaBeta(position, dt);
+        break;
+      default:
+        velocity = (AS5600_Fixed)(position - _lastPosition) * _rate.perSecond();
+        break;
+    }
+
+    if (_mode == AS5600_VEL_WINDOW) {
+      // velocities of a full window apart; the first full window would
+      // reach back to the first sample, which has no velocity
+      if (_count > Window)
+        _acceleration = as5600_mulFixed(velocity - _velocities[_oldest], _spanRate.perSecond());
+    } else if (_count >= 2) {
+      _acceleration = as5600_mulFixed(velocity - _velocity, _rate.perSecond());
+    }
+    if (_mode == AS5600_VEL_WINDOW)
+      _velocities[_head] = velocity;
+
+    _velocity = velocity;
+    _lastPosition = position;
+    _lastUs = us;
+    if (_count < 255)
+      _count++;
+  }
+
+  // counts/s and counts/s^2, 16 fraction bits
+  AS5600_Fixed velocity() const { return _velocity; }
+  AS5600_Fixed acceleration() const { return _acceleration; }
+
+private:
+
+  AS5600_VelocityMode _mode;
+  long _alpha;
+  long _beta;
+
+  uint8_t _count;          // samples seen, saturating
+  long _lastPosition;
+  unsigned long _lastUs;
+  AS5600_Reciprocal _rate; // of the last sample interval
+  AS5600_Fixed _velocity;
+  AS5600_Fixed _acceleration;
+
+  // moving window
+  long _positions[Window];
+  unsigned long _times[Window];
+  AS5600_Fixed _velocities[Window];
+  uint8_t _head;           // slot of the newest sample
+  uint8_t _oldest;         // slot the current span starts at
+  AS5600_Reciprocal _spanRate;
+
+  // alpha-beta state, position with 16 fraction bits
+  AS5600_Fixed _estimate;
+
+  void start(long position, unsigned long us)
+  {
+    _lastPosition = position;
+    _lastUs = us;
+    _head = 0;
+    _oldest = 0;
+    _positions[0] = position;
+    _times[0] = us;
+    _velocities[0] = 0;
+    _estimate = (AS5600_Fixed)position << 16;
+    _velocity = 0;
+    _acceleration = 0;
+    _count = 1;
+  }
+
+  // velocity over the span from the oldest kept sample to this one
+  AS5600_Fixed window(long position, unsigned long us)
+  {
+    // the span starts at the first sample until the ring is full,
+    // then at the sample about to be overwritten
+    uint8_t next = (_head + 1) & (Window - 1);
+    _oldest = (_count < Window) ? 0 : next;
+    long fromPosition = _positions[_oldest];
+    unsigned long fromUs = _times[_oldest];
+    _head = next;
+    _positions[_head] = position;
+    _times[_head] = us;
+
+    _spanRate.update(us - fromUs);
+    return (AS5600_Fixed)(position - fromPosition) * _spanRate.perSecond();
+  }
+
+  // predict with the current velocity, correct with the residual
+  AS5600_Fixed alphaBeta(long position, uint32_t dt)
+  {
+    AS5600_Fixed predicted = _estimate + as5600_advance(_velocity, dt);
+    AS5600_Fixed residual = ((AS5600_Fixed)position << 16) - predicted;
+
+    _estimate = predicted + as5600_mulFixed(residual, _alpha);
+    return _velocity + as5600_mulFixed(as5600_mulFixed(residual, _beta), _rate.perSecond());
+  }
+};
+
+#endif